@@ -0,0 +1,613 @@
+#include "GestureDetector.h"
+#include "GestureTrace.h"
+#include "pinch_trace.h"
+
+// Benchmarks for the gesture detector library. Runs on the Giga
+// and prints its results to the serial port; no touches are needed.
+// It can also be run on a Linux host with make bench in extras/host.
+// Touches are made up and fed to processFrame() with a made-up clock,
+// so the results don't depend on the touch controller, except for the
+// timings of poll(), which reads it.
+
+GestureDetector detector;
+
+// Number of operations per timing run, and number of runs. The median
+// run is reported, so a stray interrupt doesn't skew the results.
+#define ITERATIONS  10000
+#define REPS        5
+
+// Random points used by the benchmarks
+int px[ITERATIONS], py[ITERATIONS];
+
+void make_points(void)
+{
+  for (int k = 0; k < ITERATIONS; k++)
+  {
+    px[k] = random(0, WIDTH);
+    py[k] = random(0, HEIGHT);
+  }
+}
+
+// Run a benchmark function (which does ITERATIONS operations) REPS times
+// and return the median time in ns/op.
+typedef void (*BenchFn)(void);
+
+unsigned long bench(BenchFn fn)
+{
+  unsigned long t[REPS], start;
+
+  for (int r = 0; r < REPS; r++)
+  {
+    start = micros();
+    fn();
+    t[r] = micros() - start;
+  }
+
+  // Sort the (few) times to find the median
+  for (int i = 1; i < REPS; i++)
+  {
+    for (int j = i; j > 0 && t[j] < t[j - 1]; j--)
+    {
+      unsigned long tmp = t[j];
+      t[j] = t[j - 1];
+      t[j - 1] = tmp;
+    }
+  }
+  return (t[REPS / 2] * 1000) / ITERATIONS;
+}
+
+void report(const char *name, int n, unsigned long ns)
+{
+  Serial.print(name);
+  Serial.print(" ");
+  Serial.print(n);
+  Serial.print(": ");
+  Serial.print(ns);
+  Serial.println(" ns/op");
+}
+
+// Callbacks that do nothing, so only the detector is timed.
+void tap_cb(EventType ev, int indx, void *param, int x, int y)
+{
+}
+
+void drag_cb(EventType ev, int indx, void *param, int x, int y, int dx, int dy)
+{
+}
+
+void pinch_cb(EventType ev, int indx, void *param, int dx, int dy, float sx, float sy)
+{
+}
+
+// Point in polygon, for a regular polygon of n vertices in the middle of the screen.
+Point poly[MAX_POINTS + 1];
+int poly_n;
+volatile int sink;
+
+void run_in_polygon(void)
+{
+  for (int k = 0; k < ITERATIONS; k++)
+    sink = Point(px[k], py[k]).in_polygon(poly, poly_n);
+}
+
+void bench_in_polygon(void)
+{
+  int counts[] = { 4, 8, MAX_POINTS };
+
+  for (int c = 0; c < 3; c++)
+  {
+    poly_n = counts[c];
+    for (int i = 0; i < poly_n; i++)
+      poly[i] = Point(WIDTH / 2 + 200 * cos(i * 2 * PI / poly_n), HEIGHT / 2 + 200 * sin(i * 2 * PI / poly_n));
+    poly[poly_n] = poly[0];
+    report("in_polygon, vertices", poly_n, bench(run_in_polygon));
+  }
+}
+
+// The most regions for the benchmarks other than findEvent's, which are the
+// same whatever MAX_EVENTS is built with.
+#define REGIONS     (MAX_EVENTS < 20 ? MAX_EVENTS : 20)
+
+// Register n regions of random size scattered over the screen, in the highest
+// priority indices. If mixed, they cycle through taps, drags, swipes and pinches;
+// otherwise they are all taps.
+void register_regions(int n, bool mixed)
+{
+  randomSeed(1);
+  for (int i = 0; i < MAX_EVENTS; i++)
+    detector.cancelEvent(i);
+  for (int i = MAX_EVENTS - n; i < MAX_EVENTS; i++)
+  {
+    int w = random(40, 120);
+    int h = random(40, 120);
+    int x = random(0, WIDTH - w);
+    int y = random(0, HEIGHT - h);
+
+    switch (mixed ? i % 4 : 0)
+    {
+    case 0:
+      detector.onTap(x, y, w, h, tap_cb, i);
+      break;
+    case 1:
+      detector.onDrag(x, y, w, h, drag_cb, i);
+      break;
+    case 2:
+      detector.onSwipe(x, y, w, h, drag_cb, i);
+      break;
+    case 3:
+      detector.onPinch(x, y, w, h, pinch_cb, i);
+      break;
+    }
+  }
+}
+
+// Find the event under a point, with and without the hit map. MAX_EVENTS is a
+// compile-time limit, so counts above it are skipped; build with a larger one
+// (e.g. -DMAX_EVENTS=512, as make bench does) to see them all.
+void run_find_event(void)
+{
+  for (int k = 0; k < ITERATIONS; k++)
+    sink = detector.findEvent(EV_TAP, px[k], py[k]);
+}
+
+void bench_find_event(void)
+{
+  int counts[] = { 20, 100, 500 };
+
+  for (int c = 0; c < 3; c++)
+  {
+    if (counts[c] > MAX_EVENTS)
+      continue;
+    detector.setHitMap(false);
+    register_regions(counts[c], false);
+    report("findEvent linear, regions", counts[c], bench(run_find_event));
+    detector.setHitMap(true);
+    report("findEvent hit map, regions", counts[c], bench(run_find_event));
+  }
+  detector.setHitMap(false);
+}
+
+// Whole frames through processFrame, for a stream of gestures at random points:
+// one-finger presses that are held and dragged, and two-finger pinches.
+// Each gesture is 10 frames of FRAME_TIME ms, the last one being the release.
+#define FRAME_TIME  30
+unsigned long frame_time;
+
+void run_frames(void)
+{
+  TouchContact c[2];
+
+  for (int k = 0; k < ITERATIONS; k++)
+  {
+    int g = k / 10;             // which gesture
+    int f = k % 10;             // which frame of it
+    uint8_t contacts = (f == 9) ? 0 : (g % 3 == 2) ? 2 : 1;
+
+    c[0].x = px[g] + f * 4;
+    c[0].y = py[g];
+    c[0].id = 0;
+    c[0].area = 10;
+    c[1].x = px[g + 1] - f * 4;
+    c[1].y = py[g + 1];
+    c[1].id = 1;
+    c[1].area = 10;
+    frame_time += FRAME_TIME;
+    detector.processFrame(frame_time, contacts, c);
+  }
+}
+
+void bench_frames(void)
+{
+  int counts[] = { 5, 10, REGIONS };
+
+  for (int c = 0; c < 3; c++)
+  {
+    register_regions(counts[c], true);
+    report("processFrame, mixed regions", counts[c], bench(run_frames));
+  }
+}
+
+// Drags that never settle on an event: n vertical-only drag regions scattered
+// over the screen, and a contact that keeps landing in the middle and moving
+// sideways. Such a drag looks for its event on every frame, but only checks
+// the direction against the regions found under it when it landed, so the
+// time per frame should not grow with the number of regions.
+void register_vertical_drags(int n)
+{
+  randomSeed(1);
+  for (int i = 0; i < MAX_EVENTS; i++)
+    detector.cancelEvent(i);
+  for (int i = MAX_EVENTS - n; i < MAX_EVENTS; i++)
+  {
+    int w = random(40, 120);
+    int h = random(40, 120);
+    detector.onDrag(random(0, WIDTH - w), random(0, HEIGHT - h), w, h, drag_cb, i, NULL, CO_VERT);
+  }
+  detector.onDrag(WIDTH / 2 - 60, HEIGHT / 2 - 60, 120, 120, drag_cb, MAX_EVENTS - 1, NULL, CO_VERT);
+}
+
+void run_unsettled(void)
+{
+  TouchContact c;
+
+  for (int k = 0; k < ITERATIONS; k++)
+  {
+    int f = k % 50;             // which frame of the drag
+
+    c.x = WIDTH / 2 + f;
+    c.y = HEIGHT / 2;
+    c.id = 0;
+    c.area = 10;
+    frame_time += FRAME_TIME;
+    detector.processFrame(frame_time, (f == 49) ? 0 : 1, &c);
+  }
+}
+
+void bench_unsettled(void)
+{
+  int counts[] = { 5, 10, REGIONS };
+
+  for (int c = 0; c < 3; c++)
+  {
+    register_vertical_drags(counts[c]);
+    report("unsettled drag frame, regions", counts[c], bench(run_unsettled));
+  }
+}
+
+// The mixed frames again, with recognisers of the app's own that never want
+// the contacts. They only bid when a contact lands, so the cost per frame
+// should hardly grow with the number of them.
+int no_bid(void *param, unsigned long time, uint8_t contacts, const TouchContact *c)
+{
+  return 0;
+}
+
+void no_frame(void *param, unsigned long time, uint8_t contacts, const TouchContact *c)
+{
+}
+
+void bench_recognizers(void)
+{
+  int r[MAX_RECOGNIZERS];
+
+  register_regions(REGIONS, true);
+  report("processFrame, recognisers", 0, bench(run_frames));
+  for (int n = 0; n < MAX_RECOGNIZERS; n++)
+  {
+    r[n] = detector.addRecognizer(no_bid, no_frame);
+    report("processFrame, recognisers", n + 1, bench(run_frames));
+  }
+  for (int n = 0; n < MAX_RECOGNIZERS; n++)
+    detector.removeRecognizer(r[n], frame_time);
+}
+
+// Whole polls, for the stream of gestures of run_frames: reading the controller,
+// calibrating and rotating the points, and processFrame. On the host the touches
+// are given to the stand-in controller; on the Giga nothing is touching it, so
+// every frame is empty. Each poll is made when its scan is due.
+void gesture_points(int k, GDTpoint_t *p, uint8_t *contacts)
+{
+  int g = k / 10;
+  int f = k % 10;
+
+  *contacts = (f == 9) ? 0 : (g % 3 == 2) ? 2 : 1;
+  memset(p, 0, 2 * sizeof(GDTpoint_t));
+  p[0].trackId = 0;
+  p[0].x = px[g] + f * 4;
+  p[0].y = py[g];
+  p[0].area = 10;
+  p[1].trackId = 1;
+  p[1].x = px[g + 1] - f * 4;
+  p[1].y = py[g + 1];
+  p[1].area = 10;
+}
+
+void run_poll(void)
+{
+  GDTpoint_t p[2];
+  uint8_t contacts;
+
+  for (int k = 0; k < ITERATIONS; k++)
+  {
+    gesture_points(k, p, &contacts);
+#ifdef HOST_TOUCH
+    host_touch(contacts, p);
+#endif
+    frame_time = detector.nextPollDue();
+    detector.poll(frame_time);
+  }
+}
+
+// A poll made before its scan is due, which should return at once.
+void run_poll_early(void)
+{
+  for (int k = 0; k < ITERATIONS; k++)
+    detector.poll(detector.nextPollDue() - 1);
+}
+
+// Capture mode: the same gestures, queued a frame at a time as the controller's
+// interrupt would, and drained by a poll after every n of them (ns per frame).
+int drain_every;
+
+void run_capture(void)
+{
+  GDTpoint_t p[2];
+  uint8_t contacts;
+
+  for (int k = 0; k < ITERATIONS; k++)
+  {
+    gesture_points(k, p, &contacts);
+    frame_time += FRAME_TIME;
+    detector.pushSample(frame_time, contacts, p);
+    if (k % drain_every == drain_every - 1)
+      detector.poll(frame_time);
+  }
+}
+
+void bench_poll(void)
+{
+  GDTpoint_t p[1];
+
+  register_regions(REGIONS, true);
+  report("poll, scan due, regions", REGIONS, bench(run_poll));
+  report("poll, not due, regions", REGIONS, bench(run_poll_early));
+
+  detector.beginCapture();
+  for (drain_every = 1; drain_every <= 4; drain_every *= 4)
+    report("poll, capture drain, frames per poll", drain_every, bench(run_capture));
+  detector.endCapture();
+#ifdef HOST_TOUCH
+  host_touch(0, p);
+#endif
+}
+
+// Constraint enforcement on random drags
+void run_constraints(void)
+{
+  int dx, dy;
+
+  for (int k = 0; k < ITERATIONS; k++)
+    sink = enforce_constraints(CO_NONE, 3, px[k] - WIDTH / 2, py[k] - HEIGHT / 2, &dx, &dy);
+}
+
+// A recorded pinch: the two contacts start apart and then spread, squeeze
+// and turn about the middle of the screen. They never pass level or upright,
+// where the float solver's non-rotatable case would divide by zero.
+#define PINCH_FRAMES  200
+int trace_x0[PINCH_FRAMES], trace_y0[PINCH_FRAMES];
+int trace_x1[PINCH_FRAMES], trace_y1[PINCH_FRAMES];
+PinchStart ps;
+bool rotatable;
+
+void make_pinch_trace(void)
+{
+  for (int k = 0; k < PINCH_FRAMES; k++)
+  {
+    float r = 100 + 80 * sin(k * 0.05);
+    float a = 0.4 + 0.3 * sin(k * 0.03);
+    trace_x0[k] = WIDTH / 2 - r * cos(a);
+    trace_y0[k] = HEIGHT / 2 - r * sin(a);
+    trace_x1[k] = WIDTH / 2 + r * cos(a);
+    trace_y1[k] = HEIGHT / 2 + r * sin(a);
+  }
+  pinch_start(&ps, trace_x0[0], trace_y0[0], trace_x1[0], trace_y1[0]);
+}
+
+void run_pinch_float(void)
+{
+  int dx, dy;
+  float sx, sy;
+
+  for (int k = 0; k < ITERATIONS; k++)
+  {
+    int f = k % PINCH_FRAMES;
+    pinch_solve_float(&ps, trace_x0[f], trace_y0[f], trace_x1[f], trace_y1[f], rotatable, CO_NONE, &dx, &dy, &sx, &sy);
+    sink = dx;
+  }
+}
+
+void run_pinch_fixed(void)
+{
+  int dx, dy;
+  float sx, sy;
+
+  for (int k = 0; k < ITERATIONS; k++)
+  {
+    int f = k % PINCH_FRAMES;
+    pinch_solve_fixed(&ps, trace_x0[f], trace_y0[f], trace_x1[f], trace_y1[f], rotatable, CO_NONE, &dx, &dy, &sx, &sy);
+    sink = dx;
+  }
+}
+
+// Time the pinch solvers over the trace (rotatable = 0 or 1), and report the
+// largest difference between the float and fixed point results.
+void bench_pinch(bool rot)
+{
+  int dx, dy, fdx, fdy;
+  float sx, sy, fsx, fsy, err_s = 0, err_d = 0;
+
+  rotatable = rot;
+  for (int k = 0; k < PINCH_FRAMES; k++)
+  {
+    pinch_solve_float(&ps, trace_x0[k], trace_y0[k], trace_x1[k], trace_y1[k], rotatable, CO_NONE, &dx, &dy, &sx, &sy);
+    pinch_solve_fixed(&ps, trace_x0[k], trace_y0[k], trace_x1[k], trace_y1[k], rotatable, CO_NONE, &fdx, &fdy, &fsx, &fsy);
+    err_s = max(err_s, max(fabs(sx - fsx), fabs(sy - fsy)));
+    err_d = max(err_d, (float)max(abs(dx - fdx), abs(dy - fdy)));
+  }
+
+  report("pinch float, rotatable", rot, bench(run_pinch_float));
+  report("pinch fixed, rotatable", rot, bench(run_pinch_fixed));
+  Serial.print("  max fixed point error: scale ");
+  Serial.print(err_s, 5);
+  Serial.print(", translation ");
+  Serial.println(err_d, 0);
+}
+
+// The recorded pinch (pinch_trace.h), replayed through the detector with each
+// solver, for a pinch region that is rotatable (1) or not (0). Reports the time
+// per frame, and the largest difference between the callbacks made with the
+// fixed point solver and those made with the float one.
+#define MAX_REPLAY_CBS  256
+GestureRecord replay_cbs[2][MAX_REPLAY_CBS];
+int replay_ncbs[2];
+int replay_solver;
+long replay_frames;
+
+void record_cb(const GestureRecord *rec, void *ctx)
+{
+  if (replay_ncbs[replay_solver] < MAX_REPLAY_CBS)
+    replay_cbs[replay_solver][replay_ncbs[replay_solver]++] = *rec;
+}
+
+void run_replay(void)
+{
+  for (long k = 0; k < ITERATIONS; k += replay_frames)
+  {
+    TraceReader reader(pinch_trace, sizeof(pinch_trace));
+    sink = replayTrace(&detector, &reader);
+  }
+}
+
+void bench_replay(bool rot)
+{
+  float err_s = 0, err_t = 0, err_d = 0;
+
+  for (int i = 0; i < MAX_EVENTS; i++)
+    detector.cancelEvent(i);
+  detector.onPinch(0, 0, WIDTH, HEIGHT, pinch_cb, 0, NULL, rot);
+  for (replay_solver = 0; replay_solver < 2; replay_solver++)
+  {
+    TraceReader reader(pinch_trace, sizeof(pinch_trace));
+
+    detector.setFixedPointPinch(replay_solver == 1);
+    replay_ncbs[replay_solver] = 0;
+    detector.setObserver(record_cb);
+    replay_frames = replayTrace(&detector, &reader);
+    detector.setObserver(NULL);
+    if (replay_frames <= 0)
+    {
+      Serial.println("pinch trace: not for this screen");
+      return;
+    }
+    report(replay_solver ? "replay pinch fixed, rotatable" : "replay pinch float, rotatable", rot, bench(run_replay));
+  }
+  detector.setFixedPointPinch(false);
+
+  if (replay_ncbs[0] != replay_ncbs[1])
+  {
+    Serial.println("  the solvers made different numbers of callbacks");
+    return;
+  }
+  for (int k = 0; k < replay_ncbs[0]; k++)
+  {
+    GestureRecord *f = &replay_cbs[0][k], *q = &replay_cbs[1][k];
+
+    err_s = max(err_s, max(fabs(f->sx - q->sx), fabs(f->sy - q->sy)));
+    err_t = max(err_t, max(fabs(f->tx - q->tx), fabs(f->ty - q->ty)));
+    err_d = max(err_d, (float)max(abs(f->dx - q->dx), abs(f->dy - q->dy)));
+  }
+  Serial.print("  callbacks: ");
+  Serial.print(replay_ncbs[0]);
+  Serial.print(", max fixed point error: scale ");
+  Serial.print(err_s, 5);
+  Serial.print(", translation ");
+  Serial.print(err_d, 0);
+  Serial.print(" (");
+  Serial.print(err_t, 3);
+  Serial.println(" unrounded)");
+}
+
+// Stroke recognition: finishing a stroke (resampling its path), and matching it
+// against 16 to 64 templates, given as the number of strokes matched a second.
+// The templates and strokes are random 8-point paths.
+#define MAX_TEMPLATES 64
+#define TEST_STROKES  8
+StrokeVector templates[MAX_TEMPLATES], strokes[TEST_STROKES];
+StrokePath path;
+int ntemplates;
+
+void make_strokes(void)
+{
+  Point pts[8];
+
+  for (int k = 0; k < MAX_TEMPLATES + TEST_STROKES; k++)
+  {
+    for (int i = 0; i < 8; i++)
+      pts[i] = Point(random(0, 200), random(0, 200));
+    if (k < MAX_TEMPLATES)
+      stroke_template(&templates[k], pts, 8);
+    else
+      stroke_template(&strokes[k - MAX_TEMPLATES], pts, 8);
+  }
+
+  // A full buffer's worth of path, as drawn.
+  stroke_begin(&path, px[0], py[0]);
+  for (int k = 1; k < STROKE_BUFFER; k++)
+    stroke_add(&path, px[0] + k * STROKE_STEP, py[0] + (k & 4) * STROKE_STEP);
+}
+
+void run_stroke_finish(void)
+{
+  StrokeVector v;
+
+  for (int k = 0; k < ITERATIONS; k++)
+    sink = stroke_finish(&v, &path);
+}
+
+void run_stroke_match(void)
+{
+  float score;
+
+  for (int k = 0; k < ITERATIONS; k++)
+    sink = stroke_match(&strokes[k % TEST_STROKES], templates, ntemplates, &score);
+}
+
+void bench_strokes(void)
+{
+  int counts[] = { 16, 32, MAX_TEMPLATES };
+  unsigned long ns;
+
+  report("stroke_finish, points", path.n, bench(run_stroke_finish));
+  for (int c = 0; c < 3; c++)
+  {
+    ntemplates = counts[c];
+    ns = bench(run_stroke_match);
+    report("stroke_match, templates", ntemplates, ns);
+    Serial.print("  matches/s: ");
+    Serial.println(1000000000UL / max(ns, 1UL));
+  }
+}
+
+void setup()
+{
+  Serial.begin(9600);
+  while(!Serial) {}
+
+  if (!detector.begin())
+  {
+    Serial.println("Touch controller init - FAILED");
+    while(1) ;
+  }
+
+  randomSeed(1);
+  make_points();
+  make_pinch_trace();
+  make_strokes();
+
+  bench_in_polygon();
+  bench_find_event();
+  bench_frames();
+  bench_unsettled();
+  bench_recognizers();
+  bench_poll();
+  report("enforce_constraints", 0, bench(run_constraints));
+  bench_pinch(false);
+  bench_pinch(true);
+  bench_replay(false);
+  bench_replay(true);
+  bench_strokes();
+}
+
+void loop()
+{
+}
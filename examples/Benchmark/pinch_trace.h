@@ -0,0 +1,298 @@
+#ifndef PINCH_TRACE_H
+#define PINCH_TRACE_H
+
+// A two-finger pinch as a touch trace (see GestureTrace.h), for the Benchmark
+// example: 200 frames at the scan rate, in which the fingers land a frame apart,
+// spread, squeeze back and turn about 50 degrees while the hand drifts, with a
+// pixel or so of jitter, and then lift one after the other. It was recorded with
+// setRecorder() on the host, from the stand-in controller fed with that motion,
+// so it is only as real as the motion; a trace recorded on a panel, for a
+// 480 x 800 screen, can be put in its place.
+
+const uint8_t pinch_trace[] =
+{
+  0x47, 0x44, 0x54, 0x52, 0x01, 0x00, 0xe0, 0x01, 0x20, 0x03, 0x00, 0x00,
+  0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x03, 0x1f, 0x00, 0xb2, 0x00,
+  0x80, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x19, 0x00, 0xb2, 0x00, 0x7f, 0x01,
+  0x04, 0x17, 0x00, 0x2c, 0x01, 0xc8, 0x01, 0x20, 0x00, 0x02, 0x03, 0x18,
+  0x00, 0xb2, 0x00, 0x7e, 0x01, 0x04, 0x16, 0x00, 0x2f, 0x01, 0xca, 0x01,
+  0x1f, 0x00, 0x02, 0x03, 0x18, 0x00, 0xb0, 0x00, 0x7c, 0x01, 0x04, 0x1f,
+  0x00, 0x30, 0x01, 0xcb, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x23, 0x00, 0xaf,
+  0x00, 0x79, 0x01, 0x04, 0x17, 0x00, 0x2f, 0x01, 0xca, 0x01, 0x1f, 0x00,
+  0x02, 0x03, 0x18, 0x00, 0xae, 0x00, 0x7a, 0x01, 0x04, 0x16, 0x00, 0x34,
+  0x01, 0xcc, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d, 0x00, 0xac, 0x00, 0x78,
+  0x01, 0x04, 0x17, 0x00, 0x35, 0x01, 0xcc, 0x01, 0x20, 0x00, 0x02, 0x03,
+  0x23, 0x00, 0xab, 0x00, 0x76, 0x01, 0x04, 0x1f, 0x00, 0x36, 0x01, 0xcb,
+  0x01, 0x20, 0x00, 0x02, 0x03, 0x19, 0x00, 0xaa, 0x00, 0x75, 0x01, 0x04,
+  0x1f, 0x00, 0x39, 0x01, 0xce, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x21, 0x00,
+  0xa8, 0x00, 0x76, 0x01, 0x04, 0x18, 0x00, 0x39, 0x01, 0xcd, 0x01, 0x1f,
+  0x00, 0x02, 0x03, 0x1a, 0x00, 0xa6, 0x00, 0x73, 0x01, 0x04, 0x20, 0x00,
+  0x3c, 0x01, 0xce, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1b, 0x00, 0xa7, 0x00,
+  0x72, 0x01, 0x04, 0x20, 0x00, 0x3d, 0x01, 0xcf, 0x01, 0x1e, 0x00, 0x02,
+  0x03, 0x1d, 0x00, 0xa5, 0x00, 0x71, 0x01, 0x04, 0x20, 0x00, 0x3e, 0x01,
+  0xcf, 0x01, 0x20, 0x00, 0x02, 0x03, 0x21, 0x00, 0xa5, 0x00, 0x71, 0x01,
+  0x04, 0x1a, 0x00, 0x40, 0x01, 0xd0, 0x01, 0x20, 0x00, 0x02, 0x03, 0x1e,
+  0x00, 0xa3, 0x00, 0x71, 0x01, 0x04, 0x1a, 0x00, 0x41, 0x01, 0xd0, 0x01,
+  0x1e, 0x00, 0x02, 0x03, 0x18, 0x00, 0xa1, 0x00, 0x6e, 0x01, 0x04, 0x18,
+  0x00, 0x42, 0x01, 0xd2, 0x01, 0x20, 0x00, 0x02, 0x03, 0x19, 0x00, 0xa0,
+  0x00, 0x6e, 0x01, 0x04, 0x21, 0x00, 0x45, 0x01, 0xd0, 0x01, 0x1e, 0x00,
+  0x02, 0x03, 0x1b, 0x00, 0x9f, 0x00, 0x6c, 0x01, 0x04, 0x1c, 0x00, 0x48,
+  0x01, 0xd1, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x21, 0x00, 0x9d, 0x00, 0x6c,
+  0x01, 0x04, 0x1b, 0x00, 0x4a, 0x01, 0xd1, 0x01, 0x20, 0x00, 0x02, 0x03,
+  0x20, 0x00, 0x9c, 0x00, 0x6b, 0x01, 0x04, 0x1c, 0x00, 0x49, 0x01, 0xd3,
+  0x01, 0x1e, 0x00, 0x02, 0x03, 0x1c, 0x00, 0x9c, 0x00, 0x69, 0x01, 0x04,
+  0x17, 0x00, 0x4d, 0x01, 0xd2, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x20, 0x00,
+  0x9a, 0x00, 0x68, 0x01, 0x04, 0x1c, 0x00, 0x4d, 0x01, 0xd3, 0x01, 0x1e,
+  0x00, 0x02, 0x03, 0x22, 0x00, 0x99, 0x00, 0x69, 0x01, 0x04, 0x1b, 0x00,
+  0x4f, 0x01, 0xd5, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x19, 0x00, 0x96, 0x00,
+  0x67, 0x01, 0x04, 0x1d, 0x00, 0x4e, 0x01, 0xd4, 0x01, 0x1e, 0x00, 0x02,
+  0x03, 0x21, 0x00, 0x96, 0x00, 0x67, 0x01, 0x04, 0x1f, 0x00, 0x50, 0x01,
+  0xd3, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1c, 0x00, 0x95, 0x00, 0x67, 0x01,
+  0x04, 0x1c, 0x00, 0x53, 0x01, 0xd4, 0x01, 0x20, 0x00, 0x02, 0x03, 0x23,
+  0x00, 0x95, 0x00, 0x66, 0x01, 0x04, 0x1c, 0x00, 0x55, 0x01, 0xd6, 0x01,
+  0x1f, 0x00, 0x02, 0x03, 0x22, 0x00, 0x91, 0x00, 0x64, 0x01, 0x04, 0x21,
+  0x00, 0x55, 0x01, 0xd4, 0x01, 0x20, 0x00, 0x02, 0x03, 0x18, 0x00, 0x92,
+  0x00, 0x65, 0x01, 0x04, 0x19, 0x00, 0x5a, 0x01, 0xd4, 0x01, 0x1f, 0x00,
+  0x02, 0x03, 0x1e, 0x00, 0x90, 0x00, 0x63, 0x01, 0x04, 0x1f, 0x00, 0x5a,
+  0x01, 0xd5, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x18, 0x00, 0x8e, 0x00, 0x61,
+  0x01, 0x04, 0x16, 0x00, 0x5c, 0x01, 0xd5, 0x01, 0x1f, 0x00, 0x02, 0x03,
+  0x22, 0x00, 0x8c, 0x00, 0x61, 0x01, 0x04, 0x1b, 0x00, 0x5d, 0x01, 0xd4,
+  0x01, 0x20, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x8b, 0x00, 0x62, 0x01, 0x04,
+  0x18, 0x00, 0x5c, 0x01, 0xd4, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1e, 0x00,
+  0x89, 0x00, 0x62, 0x01, 0x04, 0x1e, 0x00, 0x5f, 0x01, 0xd4, 0x01, 0x1e,
+  0x00, 0x02, 0x03, 0x1b, 0x00, 0x87, 0x00, 0x61, 0x01, 0x04, 0x1b, 0x00,
+  0x62, 0x01, 0xd4, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x22, 0x00, 0x87, 0x00,
+  0x60, 0x01, 0x04, 0x16, 0x00, 0x63, 0x01, 0xd5, 0x01, 0x20, 0x00, 0x02,
+  0x03, 0x1c, 0x00, 0x86, 0x00, 0x5f, 0x01, 0x04, 0x1a, 0x00, 0x65, 0x01,
+  0xd5, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1c, 0x00, 0x83, 0x00, 0x5e, 0x01,
+  0x04, 0x16, 0x00, 0x65, 0x01, 0xd6, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1e,
+  0x00, 0x82, 0x00, 0x5f, 0x01, 0x04, 0x19, 0x00, 0x69, 0x01, 0xd5, 0x01,
+  0x20, 0x00, 0x02, 0x03, 0x22, 0x00, 0x82, 0x00, 0x60, 0x01, 0x04, 0x21,
+  0x00, 0x69, 0x01, 0xd5, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x19, 0x00, 0x7f,
+  0x00, 0x5e, 0x01, 0x04, 0x16, 0x00, 0x6b, 0x01, 0xd3, 0x01, 0x1f, 0x00,
+  0x02, 0x03, 0x1b, 0x00, 0x7e, 0x00, 0x5f, 0x01, 0x04, 0x1e, 0x00, 0x6d,
+  0x01, 0xd3, 0x01, 0x20, 0x00, 0x02, 0x03, 0x20, 0x00, 0x7b, 0x00, 0x5e,
+  0x01, 0x04, 0x1b, 0x00, 0x6e, 0x01, 0xd4, 0x01, 0x1f, 0x00, 0x02, 0x03,
+  0x20, 0x00, 0x7c, 0x00, 0x5e, 0x01, 0x04, 0x1c, 0x00, 0x70, 0x01, 0xd2,
+  0x01, 0x1f, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x7b, 0x00, 0x5d, 0x01, 0x04,
+  0x1b, 0x00, 0x74, 0x01, 0xd2, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1f, 0x00,
+  0x7b, 0x00, 0x5f, 0x01, 0x04, 0x18, 0x00, 0x76, 0x01, 0xd2, 0x01, 0x20,
+  0x00, 0x02, 0x03, 0x1f, 0x00, 0x79, 0x00, 0x5f, 0x01, 0x04, 0x20, 0x00,
+  0x75, 0x01, 0xd1, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1e, 0x00, 0x76, 0x00,
+  0x60, 0x01, 0x04, 0x1a, 0x00, 0x76, 0x01, 0xd1, 0x01, 0x1f, 0x00, 0x02,
+  0x03, 0x1c, 0x00, 0x75, 0x00, 0x5e, 0x01, 0x04, 0x19, 0x00, 0x7a, 0x01,
+  0xd0, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x21, 0x00, 0x72, 0x00, 0x5e, 0x01,
+  0x04, 0x20, 0x00, 0x7a, 0x01, 0xce, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d,
+  0x00, 0x72, 0x00, 0x5e, 0x01, 0x04, 0x18, 0x00, 0x7b, 0x01, 0xce, 0x01,
+  0x1f, 0x00, 0x02, 0x03, 0x1d, 0x00, 0x71, 0x00, 0x61, 0x01, 0x04, 0x16,
+  0x00, 0x7e, 0x01, 0xcc, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x23, 0x00, 0x70,
+  0x00, 0x5f, 0x01, 0x04, 0x18, 0x00, 0x80, 0x01, 0xcc, 0x01, 0x20, 0x00,
+  0x02, 0x03, 0x1e, 0x00, 0x6f, 0x00, 0x61, 0x01, 0x04, 0x21, 0x00, 0x80,
+  0x01, 0xcc, 0x01, 0x20, 0x00, 0x02, 0x03, 0x20, 0x00, 0x6c, 0x00, 0x62,
+  0x01, 0x04, 0x17, 0x00, 0x82, 0x01, 0xcb, 0x01, 0x1e, 0x00, 0x02, 0x03,
+  0x19, 0x00, 0x6b, 0x00, 0x63, 0x01, 0x04, 0x19, 0x00, 0x84, 0x01, 0xc8,
+  0x01, 0x1f, 0x00, 0x02, 0x03, 0x23, 0x00, 0x6b, 0x00, 0x61, 0x01, 0x04,
+  0x1f, 0x00, 0x86, 0x01, 0xc9, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1b, 0x00,
+  0x69, 0x00, 0x63, 0x01, 0x04, 0x1e, 0x00, 0x86, 0x01, 0xc7, 0x01, 0x1f,
+  0x00, 0x02, 0x03, 0x18, 0x00, 0x6a, 0x00, 0x62, 0x01, 0x04, 0x1d, 0x00,
+  0x8a, 0x01, 0xc6, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x23, 0x00, 0x67, 0x00,
+  0x63, 0x01, 0x04, 0x1c, 0x00, 0x8b, 0x01, 0xc5, 0x01, 0x1f, 0x00, 0x02,
+  0x03, 0x1e, 0x00, 0x65, 0x00, 0x64, 0x01, 0x04, 0x17, 0x00, 0x8a, 0x01,
+  0xc3, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1d, 0x00, 0x66, 0x00, 0x66, 0x01,
+  0x04, 0x16, 0x00, 0x8d, 0x01, 0xc3, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x19,
+  0x00, 0x64, 0x00, 0x66, 0x01, 0x04, 0x1a, 0x00, 0x8f, 0x01, 0xc0, 0x01,
+  0x1f, 0x00, 0x02, 0x03, 0x18, 0x00, 0x63, 0x00, 0x66, 0x01, 0x04, 0x1e,
+  0x00, 0x8f, 0x01, 0xc0, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1f, 0x00, 0x64,
+  0x00, 0x69, 0x01, 0x04, 0x1f, 0x00, 0x92, 0x01, 0xbe, 0x01, 0x1f, 0x00,
+  0x02, 0x03, 0x1a, 0x00, 0x60, 0x00, 0x6a, 0x01, 0x04, 0x1b, 0x00, 0x91,
+  0x01, 0xbe, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1c, 0x00, 0x61, 0x00, 0x69,
+  0x01, 0x04, 0x1d, 0x00, 0x95, 0x01, 0xbc, 0x01, 0x1f, 0x00, 0x02, 0x03,
+  0x1a, 0x00, 0x60, 0x00, 0x6c, 0x01, 0x04, 0x20, 0x00, 0x95, 0x01, 0xbb,
+  0x01, 0x1e, 0x00, 0x02, 0x03, 0x1d, 0x00, 0x5d, 0x00, 0x6d, 0x01, 0x04,
+  0x1d, 0x00, 0x95, 0x01, 0xb9, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x19, 0x00,
+  0x5d, 0x00, 0x6c, 0x01, 0x04, 0x1e, 0x00, 0x98, 0x01, 0xb8, 0x01, 0x20,
+  0x00, 0x02, 0x03, 0x19, 0x00, 0x5d, 0x00, 0x6d, 0x01, 0x04, 0x1b, 0x00,
+  0x98, 0x01, 0xb6, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x22, 0x00, 0x5d, 0x00,
+  0x70, 0x01, 0x04, 0x21, 0x00, 0x9a, 0x01, 0xb3, 0x01, 0x1f, 0x00, 0x02,
+  0x03, 0x1b, 0x00, 0x5d, 0x00, 0x6f, 0x01, 0x04, 0x17, 0x00, 0x9c, 0x01,
+  0xb3, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d, 0x00, 0x5a, 0x00, 0x70, 0x01,
+  0x04, 0x1c, 0x00, 0x9b, 0x01, 0xaf, 0x01, 0x20, 0x00, 0x02, 0x03, 0x21,
+  0x00, 0x5a, 0x00, 0x71, 0x01, 0x04, 0x18, 0x00, 0x9e, 0x01, 0xaf, 0x01,
+  0x1f, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x59, 0x00, 0x74, 0x01, 0x04, 0x1f,
+  0x00, 0x9c, 0x01, 0xac, 0x01, 0x20, 0x00, 0x02, 0x03, 0x21, 0x00, 0x57,
+  0x00, 0x75, 0x01, 0x04, 0x1b, 0x00, 0x9d, 0x01, 0xad, 0x01, 0x1f, 0x00,
+  0x02, 0x03, 0x22, 0x00, 0x56, 0x00, 0x77, 0x01, 0x04, 0x19, 0x00, 0xa0,
+  0x01, 0xa9, 0x01, 0x20, 0x00, 0x02, 0x03, 0x20, 0x00, 0x56, 0x00, 0x78,
+  0x01, 0x04, 0x17, 0x00, 0xa0, 0x01, 0xa7, 0x01, 0x20, 0x00, 0x02, 0x03,
+  0x1c, 0x00, 0x56, 0x00, 0x79, 0x01, 0x04, 0x1e, 0x00, 0xa0, 0x01, 0xa6,
+  0x01, 0x20, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x54, 0x00, 0x7a, 0x01, 0x04,
+  0x1a, 0x00, 0xa1, 0x01, 0xa4, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1c, 0x00,
+  0x55, 0x00, 0x7a, 0x01, 0x04, 0x20, 0x00, 0xa2, 0x01, 0xa4, 0x01, 0x20,
+  0x00, 0x02, 0x03, 0x18, 0x00, 0x53, 0x00, 0x7b, 0x01, 0x04, 0x1e, 0x00,
+  0xa2, 0x01, 0xa1, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x53, 0x00,
+  0x7c, 0x01, 0x04, 0x21, 0x00, 0xa2, 0x01, 0xa0, 0x01, 0x20, 0x00, 0x02,
+  0x03, 0x21, 0x00, 0x57, 0x00, 0x7c, 0x01, 0x04, 0x1a, 0x00, 0xa4, 0x01,
+  0xa0, 0x01, 0x20, 0x00, 0x02, 0x03, 0x1d, 0x00, 0x54, 0x00, 0x7f, 0x01,
+  0x04, 0x1d, 0x00, 0xa5, 0x01, 0x9e, 0x01, 0x20, 0x00, 0x02, 0x03, 0x1e,
+  0x00, 0x53, 0x00, 0x81, 0x01, 0x04, 0x21, 0x00, 0xa5, 0x01, 0x9b, 0x01,
+  0x20, 0x00, 0x02, 0x03, 0x1c, 0x00, 0x53, 0x00, 0x82, 0x01, 0x04, 0x16,
+  0x00, 0xa4, 0x01, 0x9a, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1d, 0x00, 0x53,
+  0x00, 0x82, 0x01, 0x04, 0x21, 0x00, 0xa5, 0x01, 0x9a, 0x01, 0x1e, 0x00,
+  0x02, 0x03, 0x23, 0x00, 0x54, 0x00, 0x82, 0x01, 0x04, 0x1b, 0x00, 0xa8,
+  0x01, 0x98, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1c, 0x00, 0x52, 0x00, 0x83,
+  0x01, 0x04, 0x19, 0x00, 0xa5, 0x01, 0x95, 0x01, 0x1f, 0x00, 0x02, 0x03,
+  0x1d, 0x00, 0x54, 0x00, 0x83, 0x01, 0x04, 0x1b, 0x00, 0xa9, 0x01, 0x93,
+  0x01, 0x1f, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x55, 0x00, 0x84, 0x01, 0x04,
+  0x1f, 0x00, 0xa8, 0x01, 0x92, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x23, 0x00,
+  0x54, 0x00, 0x86, 0x01, 0x04, 0x18, 0x00, 0xa8, 0x01, 0x90, 0x01, 0x1f,
+  0x00, 0x02, 0x03, 0x1f, 0x00, 0x52, 0x00, 0x86, 0x01, 0x04, 0x16, 0x00,
+  0xa7, 0x01, 0x90, 0x01, 0x20, 0x00, 0x02, 0x03, 0x1f, 0x00, 0x56, 0x00,
+  0x88, 0x01, 0x04, 0x21, 0x00, 0xaa, 0x01, 0x8e, 0x01, 0x1e, 0x00, 0x02,
+  0x03, 0x1e, 0x00, 0x54, 0x00, 0x89, 0x01, 0x04, 0x18, 0x00, 0xa8, 0x01,
+  0x8c, 0x01, 0x20, 0x00, 0x02, 0x03, 0x22, 0x00, 0x54, 0x00, 0x8a, 0x01,
+  0x04, 0x1c, 0x00, 0xa9, 0x01, 0x8b, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d,
+  0x00, 0x54, 0x00, 0x8b, 0x01, 0x04, 0x16, 0x00, 0xa8, 0x01, 0x8a, 0x01,
+  0x20, 0x00, 0x02, 0x03, 0x18, 0x00, 0x56, 0x00, 0x8a, 0x01, 0x04, 0x18,
+  0x00, 0xab, 0x01, 0x89, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x56,
+  0x00, 0x8b, 0x01, 0x04, 0x1e, 0x00, 0xaa, 0x01, 0x88, 0x01, 0x20, 0x00,
+  0x02, 0x03, 0x1b, 0x00, 0x54, 0x00, 0x8d, 0x01, 0x04, 0x1f, 0x00, 0xa8,
+  0x01, 0x88, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1c, 0x00, 0x56, 0x00, 0x8d,
+  0x01, 0x04, 0x19, 0x00, 0xa6, 0x01, 0x87, 0x01, 0x1e, 0x00, 0x02, 0x03,
+  0x1c, 0x00, 0x56, 0x00, 0x8c, 0x01, 0x04, 0x1d, 0x00, 0xa8, 0x01, 0x84,
+  0x01, 0x20, 0x00, 0x02, 0x03, 0x19, 0x00, 0x57, 0x00, 0x8d, 0x01, 0x04,
+  0x1c, 0x00, 0xa8, 0x01, 0x83, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1f, 0x00,
+  0x55, 0x00, 0x8f, 0x01, 0x04, 0x1f, 0x00, 0xa8, 0x01, 0x82, 0x01, 0x1e,
+  0x00, 0x02, 0x03, 0x1e, 0x00, 0x58, 0x00, 0x8e, 0x01, 0x04, 0x1b, 0x00,
+  0xa8, 0x01, 0x83, 0x01, 0x20, 0x00, 0x02, 0x03, 0x18, 0x00, 0x59, 0x00,
+  0x90, 0x01, 0x04, 0x16, 0x00, 0xa7, 0x01, 0x82, 0x01, 0x1e, 0x00, 0x02,
+  0x03, 0x19, 0x00, 0x59, 0x00, 0x8f, 0x01, 0x04, 0x18, 0x00, 0xa6, 0x01,
+  0x82, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x5a, 0x00, 0x8e, 0x01,
+  0x04, 0x21, 0x00, 0xa9, 0x01, 0x80, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x19,
+  0x00, 0x5c, 0x00, 0x90, 0x01, 0x04, 0x1e, 0x00, 0xa9, 0x01, 0x7e, 0x01,
+  0x20, 0x00, 0x02, 0x03, 0x22, 0x00, 0x5b, 0x00, 0x91, 0x01, 0x04, 0x21,
+  0x00, 0xa6, 0x01, 0x7d, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x5b,
+  0x00, 0x90, 0x01, 0x04, 0x1c, 0x00, 0xa6, 0x01, 0x7d, 0x01, 0x1e, 0x00,
+  0x02, 0x03, 0x1a, 0x00, 0x5b, 0x00, 0x8f, 0x01, 0x04, 0x1b, 0x00, 0xa5,
+  0x01, 0x7e, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d, 0x00, 0x5e, 0x00, 0x90,
+  0x01, 0x04, 0x16, 0x00, 0xa5, 0x01, 0x7d, 0x01, 0x20, 0x00, 0x02, 0x03,
+  0x23, 0x00, 0x5e, 0x00, 0x8f, 0x01, 0x04, 0x20, 0x00, 0xa6, 0x01, 0x7d,
+  0x01, 0x1e, 0x00, 0x02, 0x03, 0x19, 0x00, 0x5c, 0x00, 0x91, 0x01, 0x04,
+  0x18, 0x00, 0xa3, 0x01, 0x7b, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x18, 0x00,
+  0x5f, 0x00, 0x90, 0x01, 0x04, 0x20, 0x00, 0xa4, 0x01, 0x7a, 0x01, 0x1f,
+  0x00, 0x02, 0x03, 0x22, 0x00, 0x5f, 0x00, 0x91, 0x01, 0x04, 0x1b, 0x00,
+  0xa4, 0x01, 0x79, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x21, 0x00, 0x5e, 0x00,
+  0x90, 0x01, 0x04, 0x19, 0x00, 0xa1, 0x01, 0x79, 0x01, 0x20, 0x00, 0x02,
+  0x03, 0x22, 0x00, 0x5f, 0x00, 0x8f, 0x01, 0x04, 0x16, 0x00, 0xa1, 0x01,
+  0x78, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1a, 0x00, 0x61, 0x00, 0x8f, 0x01,
+  0x04, 0x1b, 0x00, 0xa2, 0x01, 0x7a, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1b,
+  0x00, 0x63, 0x00, 0x91, 0x01, 0x04, 0x1d, 0x00, 0x9f, 0x01, 0x7a, 0x01,
+  0x20, 0x00, 0x02, 0x03, 0x19, 0x00, 0x62, 0x00, 0x8f, 0x01, 0x04, 0x19,
+  0x00, 0xa0, 0x01, 0x78, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1f, 0x00, 0x66,
+  0x00, 0x8f, 0x01, 0x04, 0x16, 0x00, 0xa1, 0x01, 0x77, 0x01, 0x1f, 0x00,
+  0x02, 0x03, 0x1a, 0x00, 0x67, 0x00, 0x8e, 0x01, 0x04, 0x16, 0x00, 0x9f,
+  0x01, 0x77, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x18, 0x00, 0x67, 0x00, 0x8f,
+  0x01, 0x04, 0x1a, 0x00, 0x9e, 0x01, 0x77, 0x01, 0x1f, 0x00, 0x02, 0x03,
+  0x1b, 0x00, 0x69, 0x00, 0x8e, 0x01, 0x04, 0x1b, 0x00, 0x9e, 0x01, 0x76,
+  0x01, 0x1f, 0x00, 0x02, 0x03, 0x23, 0x00, 0x69, 0x00, 0x8e, 0x01, 0x04,
+  0x1c, 0x00, 0x9f, 0x01, 0x77, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x21, 0x00,
+  0x68, 0x00, 0x8d, 0x01, 0x04, 0x17, 0x00, 0x9a, 0x01, 0x76, 0x01, 0x20,
+  0x00, 0x02, 0x03, 0x1a, 0x00, 0x6d, 0x00, 0x8e, 0x01, 0x04, 0x1a, 0x00,
+  0x9c, 0x01, 0x77, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1b, 0x00, 0x6d, 0x00,
+  0x8d, 0x01, 0x04, 0x1e, 0x00, 0x9b, 0x01, 0x77, 0x01, 0x1f, 0x00, 0x02,
+  0x03, 0x21, 0x00, 0x6c, 0x00, 0x8d, 0x01, 0x04, 0x1d, 0x00, 0x99, 0x01,
+  0x75, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1f, 0x00, 0x6d, 0x00, 0x8e, 0x01,
+  0x04, 0x21, 0x00, 0x97, 0x01, 0x76, 0x01, 0x20, 0x00, 0x02, 0x03, 0x1b,
+  0x00, 0x6f, 0x00, 0x8c, 0x01, 0x04, 0x16, 0x00, 0x97, 0x01, 0x77, 0x01,
+  0x1f, 0x00, 0x02, 0x03, 0x18, 0x00, 0x72, 0x00, 0x8c, 0x01, 0x04, 0x20,
+  0x00, 0x98, 0x01, 0x75, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x20, 0x00, 0x72,
+  0x00, 0x8d, 0x01, 0x04, 0x1f, 0x00, 0x96, 0x01, 0x75, 0x01, 0x20, 0x00,
+  0x02, 0x03, 0x1a, 0x00, 0x73, 0x00, 0x8d, 0x01, 0x04, 0x19, 0x00, 0x95,
+  0x01, 0x74, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x20, 0x00, 0x75, 0x00, 0x8d,
+  0x01, 0x04, 0x1b, 0x00, 0x95, 0x01, 0x74, 0x01, 0x1e, 0x00, 0x02, 0x03,
+  0x18, 0x00, 0x78, 0x00, 0x8b, 0x01, 0x04, 0x1c, 0x00, 0x93, 0x01, 0x74,
+  0x01, 0x20, 0x00, 0x02, 0x03, 0x20, 0x00, 0x7a, 0x00, 0x8c, 0x01, 0x04,
+  0x20, 0x00, 0x92, 0x01, 0x74, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1a, 0x00,
+  0x78, 0x00, 0x8c, 0x01, 0x04, 0x16, 0x00, 0x90, 0x01, 0x74, 0x01, 0x1e,
+  0x00, 0x02, 0x03, 0x1f, 0x00, 0x7a, 0x00, 0x89, 0x01, 0x04, 0x1f, 0x00,
+  0x91, 0x01, 0x73, 0x01, 0x20, 0x00, 0x02, 0x03, 0x22, 0x00, 0x7c, 0x00,
+  0x8a, 0x01, 0x04, 0x20, 0x00, 0x8f, 0x01, 0x74, 0x01, 0x1f, 0x00, 0x02,
+  0x03, 0x1d, 0x00, 0x7e, 0x00, 0x8b, 0x01, 0x04, 0x17, 0x00, 0x8f, 0x01,
+  0x73, 0x01, 0x20, 0x00, 0x02, 0x03, 0x22, 0x00, 0x7f, 0x00, 0x88, 0x01,
+  0x04, 0x19, 0x00, 0x8f, 0x01, 0x73, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d,
+  0x00, 0x7f, 0x00, 0x89, 0x01, 0x04, 0x17, 0x00, 0x8c, 0x01, 0x74, 0x01,
+  0x20, 0x00, 0x02, 0x03, 0x1e, 0x00, 0x82, 0x00, 0x8a, 0x01, 0x04, 0x18,
+  0x00, 0x89, 0x01, 0x74, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x21, 0x00, 0x84,
+  0x00, 0x88, 0x01, 0x04, 0x18, 0x00, 0x88, 0x01, 0x73, 0x01, 0x1e, 0x00,
+  0x02, 0x03, 0x1f, 0x00, 0x85, 0x00, 0x89, 0x01, 0x04, 0x19, 0x00, 0x89,
+  0x01, 0x74, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x19, 0x00, 0x85, 0x00, 0x88,
+  0x01, 0x04, 0x18, 0x00, 0x85, 0x01, 0x74, 0x01, 0x1e, 0x00, 0x02, 0x03,
+  0x18, 0x00, 0x87, 0x00, 0x89, 0x01, 0x04, 0x1b, 0x00, 0x86, 0x01, 0x72,
+  0x01, 0x1e, 0x00, 0x02, 0x03, 0x1d, 0x00, 0x8b, 0x00, 0x87, 0x01, 0x04,
+  0x19, 0x00, 0x85, 0x01, 0x72, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x18, 0x00,
+  0x8d, 0x00, 0x86, 0x01, 0x04, 0x18, 0x00, 0x85, 0x01, 0x72, 0x01, 0x1f,
+  0x00, 0x02, 0x03, 0x1c, 0x00, 0x8c, 0x00, 0x87, 0x01, 0x04, 0x1c, 0x00,
+  0x82, 0x01, 0x73, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x23, 0x00, 0x8e, 0x00,
+  0x88, 0x01, 0x04, 0x16, 0x00, 0x7f, 0x01, 0x71, 0x01, 0x1e, 0x00, 0x02,
+  0x03, 0x23, 0x00, 0x91, 0x00, 0x87, 0x01, 0x04, 0x1a, 0x00, 0x7e, 0x01,
+  0x72, 0x01, 0x20, 0x00, 0x02, 0x03, 0x18, 0x00, 0x92, 0x00, 0x87, 0x01,
+  0x04, 0x20, 0x00, 0x7b, 0x01, 0x71, 0x01, 0x20, 0x00, 0x02, 0x03, 0x23,
+  0x00, 0x95, 0x00, 0x87, 0x01, 0x04, 0x1f, 0x00, 0x7e, 0x01, 0x71, 0x01,
+  0x1e, 0x00, 0x02, 0x03, 0x22, 0x00, 0x97, 0x00, 0x87, 0x01, 0x04, 0x16,
+  0x00, 0x7c, 0x01, 0x71, 0x01, 0x20, 0x00, 0x02, 0x03, 0x21, 0x00, 0x99,
+  0x00, 0x87, 0x01, 0x04, 0x1a, 0x00, 0x7b, 0x01, 0x70, 0x01, 0x20, 0x00,
+  0x02, 0x03, 0x19, 0x00, 0x98, 0x00, 0x85, 0x01, 0x04, 0x20, 0x00, 0x78,
+  0x01, 0x6f, 0x01, 0x20, 0x00, 0x02, 0x03, 0x1c, 0x00, 0x99, 0x00, 0x85,
+  0x01, 0x04, 0x1a, 0x00, 0x75, 0x01, 0x6f, 0x01, 0x1f, 0x00, 0x02, 0x03,
+  0x1b, 0x00, 0x9c, 0x00, 0x86, 0x01, 0x04, 0x1f, 0x00, 0x75, 0x01, 0x6d,
+  0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d, 0x00, 0x9f, 0x00, 0x84, 0x01, 0x04,
+  0x1b, 0x00, 0x75, 0x01, 0x6f, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1e, 0x00,
+  0x9e, 0x00, 0x84, 0x01, 0x04, 0x1e, 0x00, 0x72, 0x01, 0x6e, 0x01, 0x1f,
+  0x00, 0x02, 0x03, 0x1a, 0x00, 0xa2, 0x00, 0x86, 0x01, 0x04, 0x1f, 0x00,
+  0x72, 0x01, 0x6e, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1d, 0x00, 0xa5, 0x00,
+  0x85, 0x01, 0x04, 0x21, 0x00, 0x6e, 0x01, 0x6c, 0x01, 0x1e, 0x00, 0x02,
+  0x03, 0x20, 0x00, 0xa5, 0x00, 0x86, 0x01, 0x04, 0x1c, 0x00, 0x6f, 0x01,
+  0x6c, 0x01, 0x20, 0x00, 0x02, 0x03, 0x19, 0x00, 0xa7, 0x00, 0x84, 0x01,
+  0x04, 0x19, 0x00, 0x6b, 0x01, 0x6b, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x21,
+  0x00, 0xa9, 0x00, 0x86, 0x01, 0x04, 0x1b, 0x00, 0x69, 0x01, 0x6c, 0x01,
+  0x1e, 0x00, 0x02, 0x03, 0x1d, 0x00, 0xab, 0x00, 0x84, 0x01, 0x04, 0x1e,
+  0x00, 0x69, 0x01, 0x6a, 0x01, 0x20, 0x00, 0x02, 0x03, 0x18, 0x00, 0xad,
+  0x00, 0x85, 0x01, 0x04, 0x19, 0x00, 0x66, 0x01, 0x6b, 0x01, 0x1f, 0x00,
+  0x02, 0x03, 0x21, 0x00, 0xad, 0x00, 0x84, 0x01, 0x04, 0x1c, 0x00, 0x64,
+  0x01, 0x69, 0x01, 0x20, 0x00, 0x02, 0x03, 0x18, 0x00, 0xb2, 0x00, 0x86,
+  0x01, 0x04, 0x17, 0x00, 0x62, 0x01, 0x6a, 0x01, 0x1e, 0x00, 0x02, 0x03,
+  0x1f, 0x00, 0xb5, 0x00, 0x84, 0x01, 0x04, 0x1e, 0x00, 0x62, 0x01, 0x68,
+  0x01, 0x1f, 0x00, 0x02, 0x03, 0x1e, 0x00, 0xb4, 0x00, 0x83, 0x01, 0x04,
+  0x21, 0x00, 0x5e, 0x01, 0x69, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1b, 0x00,
+  0xb6, 0x00, 0x84, 0x01, 0x04, 0x18, 0x00, 0x5f, 0x01, 0x69, 0x01, 0x20,
+  0x00, 0x02, 0x03, 0x1f, 0x00, 0xb9, 0x00, 0x84, 0x01, 0x04, 0x1e, 0x00,
+  0x5c, 0x01, 0x69, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d, 0x00, 0xbb, 0x00,
+  0x84, 0x01, 0x04, 0x16, 0x00, 0x5b, 0x01, 0x68, 0x01, 0x1f, 0x00, 0x02,
+  0x03, 0x19, 0x00, 0xbc, 0x00, 0x84, 0x01, 0x04, 0x18, 0x00, 0x59, 0x01,
+  0x67, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x21, 0x00, 0xbf, 0x00, 0x84, 0x01,
+  0x04, 0x20, 0x00, 0x57, 0x01, 0x66, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d,
+  0x00, 0xc1, 0x00, 0x84, 0x01, 0x04, 0x18, 0x00, 0x56, 0x01, 0x66, 0x01,
+  0x20, 0x00, 0x02, 0x03, 0x20, 0x00, 0xc3, 0x00, 0x83, 0x01, 0x04, 0x1a,
+  0x00, 0x53, 0x01, 0x67, 0x01, 0x20, 0x00, 0x02, 0x03, 0x1f, 0x00, 0xc3,
+  0x00, 0x83, 0x01, 0x04, 0x18, 0x00, 0x51, 0x01, 0x65, 0x01, 0x20, 0x00,
+  0x02, 0x03, 0x19, 0x00, 0xc6, 0x00, 0x84, 0x01, 0x04, 0x1d, 0x00, 0x51,
+  0x01, 0x64, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x20, 0x00, 0xc7, 0x00, 0x83,
+  0x01, 0x04, 0x16, 0x00, 0x4f, 0x01, 0x65, 0x01, 0x20, 0x00, 0x02, 0x03,
+  0x22, 0x00, 0xca, 0x00, 0x82, 0x01, 0x04, 0x1c, 0x00, 0x4c, 0x01, 0x64,
+  0x01, 0x1f, 0x00, 0x02, 0x03, 0x1e, 0x00, 0xce, 0x00, 0x82, 0x01, 0x04,
+  0x1a, 0x00, 0x4b, 0x01, 0x63, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d, 0x00,
+  0xd1, 0x00, 0x82, 0x01, 0x04, 0x17, 0x00, 0x4c, 0x01, 0x65, 0x01, 0x1e,
+  0x00, 0x02, 0x03, 0x1b, 0x00, 0xcf, 0x00, 0x83, 0x01, 0x04, 0x16, 0x00,
+  0x48, 0x01, 0x64, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x1b, 0x00, 0xd5, 0x00,
+  0x83, 0x01, 0x04, 0x16, 0x00, 0x45, 0x01, 0x63, 0x01, 0x1f, 0x00, 0x02,
+  0x03, 0x20, 0x00, 0xd6, 0x00, 0x81, 0x01, 0x04, 0x16, 0x00, 0x44, 0x01,
+  0x63, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x1d, 0x00, 0xd9, 0x00, 0x82, 0x01,
+  0x04, 0x1d, 0x00, 0x42, 0x01, 0x62, 0x01, 0x1e, 0x00, 0x02, 0x03, 0x18,
+  0x00, 0xda, 0x00, 0x81, 0x01, 0x04, 0x1d, 0x00, 0x41, 0x01, 0x62, 0x01,
+  0x1f, 0x00, 0x02, 0x03, 0x18, 0x00, 0xdc, 0x00, 0x80, 0x01, 0x04, 0x1d,
+  0x00, 0x3d, 0x01, 0x62, 0x01, 0x1f, 0x00, 0x02, 0x03, 0x20, 0x00, 0xde,
+  0x00, 0x80, 0x01, 0x04, 0x1c, 0x00, 0x3e, 0x01, 0x62, 0x01, 0x1e, 0x00,
+  0x01, 0x03, 0x1a, 0x00, 0xe0, 0x00, 0x7f, 0x01, 0x20, 0x00, 0x00, 0x33,
+  0x00, 0x00,
+};
+
+#endif // def PINCH_TRACE_H
@@ -55,6 +55,19 @@ void reset(void)
   draw_rect(cp[0], cp[1], cp[2], cp[3]);
 }
 
+void tap_cb(EventType ev, int indx, void *param, int x, int y);
+void drag_cb_box(EventType ev, int indx, void *param, int x, int y, int dx, int dy);
+
+// Register the box (as it now is in cp[]) for taps and drags, with inertia
+// so it carries on when flicked. The tap shares the drag's region, so moving
+// one with transformRegion moves both.
+void register_box(void)
+{
+  detector.onDrag(cp, 4, drag_cb_box, 5, NULL, CO_NONE, 5, true);
+  detector.onTap(cp, 4, tap_cb, 2);
+  detector.shareRegion(2, 5);
+}
+
 void tap_cb(EventType ev, int indx, void *param, int x, int y)
 {
   if ((ev & EV_RELEASED) == 0)
@@ -75,6 +88,7 @@ void tap_cb(EventType ev, int indx, void *param, int x, int y)
 void drag_cb_box(EventType ev, int indx, void *param, int x, int y, int dx, int dy)
 {
   Point p[4];
+  DamageRect r;
 
   // A drag has been released. Save the cumulative dx/dy into box_x/y.
   if (ev & EV_RELEASED)
@@ -83,6 +97,7 @@ void drag_cb_box(EventType ev, int indx, void *param, int x, int y, int dx, int
     cp[1] = cp[1].transform(dx, dy);
     cp[2] = cp[2].transform(dx, dy);
     cp[3] = cp[3].transform(dx, dy);
+    register_box();
     return;
   }
 
@@ -93,14 +108,16 @@ void drag_cb_box(EventType ev, int indx, void *param, int x, int y, int dx, int
   p[2] = cp[2].transform(dx, dy);
   p[3] = cp[3].transform(dx, dy);
   tft.startBuffering();
-  tft.fillScreen(0);
+
+  // Only clear the part of the screen the box has moved over.
+  detector.getDamage(&r);
+  tft.fillRect(r.xmin, r.ymin, r.xmax - r.xmin + 1, r.ymax - r.ymin + 1, 0);
   draw_rect(p[0], p[1], p[2], p[3]);
   Log("Drag box");
   tft.endBuffering();
 
-  // Re-origin the regions for taps and drags on box
-  detector.onTap(p, 4 , tap_cb, 2);
-  detector.onDrag(p, 4, drag_cb_box, 5);
+  // Move the region for taps and drags on box along with it
+  detector.transformRegion(5, dx, dy);
 }
 
 void drag_cb_line(EventType ev, int indx, void *param, int x, int y, int dx, int dy)
@@ -116,9 +133,8 @@ void swipe_cb(EventType ev, int indx, void *param, int x, int y, int dx, int dy)
   reset();
   Log("Clear");
 
-  // Re-origin regions using the xywh calls.
-  detector.onTap(box_x, box_y, box_w, box_h, tap_cb, 2);
-  detector.onDrag(box_x, box_y, box_w, box_h, drag_cb_box, 5);
+  // Re-origin regions
+  register_box();
 }
 
 void pinch_cb(EventType ev, int indx, void *param, int dx, int dy, float sx, float sy)
@@ -131,6 +147,7 @@ void pinch_cb(EventType ev, int indx, void *param, int dx, int dy, float sx, flo
     cp[1] = cp[1].transform(dx, dy, sx, sy);
     cp[2] = cp[2].transform(dx, dy, sx, sy);
     cp[3] = cp[3].transform(dx, dy, sx, sy);
+    register_box();
     return;
   }
 
@@ -144,9 +161,8 @@ void pinch_cb(EventType ev, int indx, void *param, int dx, int dy, float sx, flo
   Log("Pinch");
   tft.endBuffering();
 
-  // Re-origin the regions for taps and drags on box
-  detector.onTap(p, 4 , tap_cb, 2);
-  detector.onDrag(p, 4, drag_cb_box, 5);
+  // Move the region for taps and drags on box along with it
+  detector.transformRegion(5, dx, dy, sx, sy);
 }
 
 void rotatable_pinch_cb(EventType ev, int indx, void *param, int dx, int dy, float scosa, float ssina)
@@ -159,6 +175,7 @@ void rotatable_pinch_cb(EventType ev, int indx, void *param, int dx, int dy, flo
     cp[1] = cp[1].transform(dx, dy, scosa, -ssina, ssina, scosa);
     cp[2] = cp[2].transform(dx, dy, scosa, -ssina, ssina, scosa);
     cp[3] = cp[3].transform(dx, dy, scosa, -ssina, ssina, scosa);
+    register_box();
     return;
   }
 
@@ -172,9 +189,8 @@ void rotatable_pinch_cb(EventType ev, int indx, void *param, int dx, int dy, flo
   Log("Pinch");
   tft.endBuffering();
 
-  // Re-origin the regions for taps and drags on box
-  detector.onTap(p, 4 , tap_cb, 2);
-  detector.onDrag(p, 4, drag_cb_box, 5);
+  // Move the region for taps and drags on box along with it
+  detector.transformRegion(5, dx, dy, scosa, -ssina, ssina, scosa);
 }
 
 void setup() 
@@ -199,8 +215,9 @@ void setup()
   reset();
 
   // Various forms of onXxx calls:
-  // Taps and long presses inside the box
-  detector.onTap(box_x, box_y, box_w, box_h, tap_cb, 2);
+  // Taps and long presses inside the box, and dragging the box around
+  // (note the higher priority of this drag than the one below)
+  register_box();
 
   // Swiping anywhere clears the screen. 
   detector.onSwipe(0, 0, 0, 0, swipe_cb, 3);
@@ -208,9 +225,6 @@ void setup()
   // Drags outside box just draw lines/spots
   detector.onDrag(0, 0, 0, 0, drag_cb_line, 4, NULL, CO_NONE, 5);
 
-  // Drag the box around (note the higher priority of this drag)
-  detector.onDrag(box_x, box_y, box_w, box_h, drag_cb_box, 5, NULL, CO_NONE, 5);
-
   // Pinch zoom the box (from anywhere on screen). Versions for both
   // rotatable and non-rotatable pinches.
   detector.onPinch(0, 0, 0, 0, pinch_cb, 6, NULL, false, CO_NONE, 5);
@@ -0,0 +1,60 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+// A stand-in for the parts of the Arduino core the library uses, so it can be
+// built and tested on a Linux host (see the Makefile in extras/host).
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#define PI                3.1415926535897932384626433832795
+
+template<class T, class L> inline auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (b < a) ? b : a; }
+template<class T, class L> inline auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (a < b) ? b : a; }
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+// The clock. millis() follows the host's clock unless a test has set it with
+// host_set_millis(), after which it stays where it is put. micros() is always
+// the host's, for timing.
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long ms);
+void host_set_millis(unsigned long ms);
+
+long random(long howbig);
+long random(long howsmall, long howbig);
+void randomSeed(unsigned long seed);
+
+inline void interrupts(void) {}
+inline void noInterrupts(void) {}
+
+// Printing goes to stdout.
+class Print
+{
+public:
+  size_t print(const char *s) { return printf("%s", s); }
+  size_t print(char c) { return printf("%c", c); }
+  size_t print(int n) { return printf("%d", n); }
+  size_t print(unsigned int n) { return printf("%u", n); }
+  size_t print(long n) { return printf("%ld", n); }
+  size_t print(unsigned long n) { return printf("%lu", n); }
+  size_t print(double n, int digits = 2) { return printf("%.*f", digits, n); }
+  size_t println(void) { return printf("\n"); }
+  template<class T> size_t println(T v) { return print(v) + println(); }
+  size_t println(double n, int digits) { return print(n, digits) + println(); }
+};
+
+class HardwareSerial : public Print
+{
+public:
+  void begin(unsigned long baud) {}
+  operator bool() { return true; }
+};
+
+extern HardwareSerial Serial;
+
+#endif // def ARDUINO_H
@@ -0,0 +1,36 @@
+#ifndef ARDUINO_GIGA_DISPLAY_TOUCH_H
+#define ARDUINO_GIGA_DISPLAY_TOUCH_H
+
+#include "Arduino.h"
+
+// A stand-in for the touch controller. Tests say what is touching the screen
+// with host_touch(); getTouchPoints() reports it, and host_interrupt() calls
+// the handler given to onDetect() with it, as the controller's interrupt would.
+// Both can be called from another thread. HOST_TOUCH is defined so a sketch
+// can tell it has them.
+
+typedef struct __attribute__((packed)) GDTpoint_s
+{
+  uint8_t trackId;
+  uint16_t x;
+  uint16_t y;
+  uint16_t area;
+  uint8_t reserved;
+} GDTpoint_t;
+
+typedef void (*GDTHandler)(uint8_t contacts, GDTpoint_t *points);
+
+#define HOST_TOUCH
+
+void host_touch(uint8_t contacts, const GDTpoint_t *points);
+void host_interrupt(void);
+
+class Arduino_GigaDisplayTouch
+{
+public:
+  bool begin(void) { return true; }
+  uint8_t getTouchPoints(GDTpoint_t *points);
+  void onDetect(GDTHandler handler);
+};
+
+#endif // def ARDUINO_GIGA_DISPLAY_TOUCH_H
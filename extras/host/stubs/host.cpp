@@ -0,0 +1,104 @@
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include "Arduino.h"
+#include "Arduino_GigaDisplayTouch.h"
+
+HardwareSerial Serial;
+
+// The clock, real or set by a test.
+static std::atomic<bool> fixed_clock(false);
+static std::atomic<unsigned long> fixed_millis(0);
+static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+unsigned long millis(void)
+{
+  if (fixed_clock)
+    return fixed_millis;
+  return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+unsigned long micros(void)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void delay(unsigned long ms)
+{
+  if (fixed_clock)
+    fixed_millis += ms;
+  else
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void host_set_millis(unsigned long ms)
+{
+  fixed_millis = ms;
+  fixed_clock = true;
+}
+
+// The same sequence on every host, so benchmarks and tests repeat exactly.
+static uint32_t seed = 1;
+
+long random(long howbig)
+{
+  if (howbig <= 0)
+    return 0;
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 8) % howbig;
+}
+
+long random(long howsmall, long howbig)
+{
+  if (howsmall >= howbig)
+    return howsmall;
+  return random(howbig - howsmall) + howsmall;
+}
+
+void randomSeed(unsigned long s)
+{
+  seed = s;
+}
+
+// The touch controller.
+static std::mutex touch_lock;
+static GDTpoint_t touch_points[5];
+static uint8_t touch_contacts = 0;
+static std::atomic<GDTHandler> touch_handler(nullptr);
+
+void host_touch(uint8_t contacts, const GDTpoint_t *points)
+{
+  std::lock_guard<std::mutex> guard(touch_lock);
+  if (contacts > 5)
+    contacts = 5;
+  memcpy(touch_points, points, contacts * sizeof(GDTpoint_t));
+  touch_contacts = contacts;
+}
+
+void host_interrupt(void)
+{
+  GDTpoint_t points[5];
+  uint8_t contacts;
+  GDTHandler handler = touch_handler;
+
+  {
+    std::lock_guard<std::mutex> guard(touch_lock);
+    contacts = touch_contacts;
+    memcpy(points, touch_points, sizeof(points));
+  }
+  if (handler != nullptr)
+    handler(contacts, points);
+}
+
+uint8_t Arduino_GigaDisplayTouch::getTouchPoints(GDTpoint_t *points)
+{
+  std::lock_guard<std::mutex> guard(touch_lock);
+  memcpy(points, touch_points, touch_contacts * sizeof(GDTpoint_t));
+  return touch_contacts;
+}
+
+void Arduino_GigaDisplayTouch::onDetect(GDTHandler handler)
+{
+  touch_handler = handler;
+}
@@ -0,0 +1,12 @@
+// Run a sketch on the host: setup() once, then loop() once (rather than
+// forever), so a sketch that does all its work in setup() runs to the end.
+
+void setup(void);
+void loop(void);
+
+int main()
+{
+  setup();
+  loop();
+  return 0;
+}
@@ -0,0 +1,167 @@
+#ifndef TEST_H
+#define TEST_H
+
+#include "GestureDetector.h"
+
+// Helpers for the host tests. Each test is a program that feeds frames of
+// contacts to a detector (usually through processFrame, with a made-up clock),
+// checks the callbacks it makes, and returns the number of checks that failed.
+
+static int failures = 0;
+
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) \
+    { \
+      printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+      failures++; \
+    } \
+  } while (0)
+
+#define CHECK_EQ(a, b) \
+  do { \
+    long a_ = (a), b_ = (b); \
+    if (a_ != b_) \
+    { \
+      printf("%s:%d: %s is %ld, expected %ld\n", __FILE__, __LINE__, #a, a_, b_); \
+      failures++; \
+    } \
+  } while (0)
+
+#define TEST_DONE() \
+  do { \
+    printf("%s: %s (%d failed)\n", __FILE__, failures ? "FAIL" : "ok", failures); \
+    return failures != 0; \
+  } while (0)
+
+// The callbacks made, as seen by an observer (see watch()).
+#define MAX_SEEN  512
+static GestureRecord seen[MAX_SEEN];
+static int nseen = 0;
+
+static void seen_cb(const GestureRecord *rec, void *ctx)
+{
+  if (nseen < MAX_SEEN)
+    seen[nseen++] = *rec;
+}
+
+static void watch(GestureDetector *d)
+{
+  nseen = 0;
+  d->setObserver(seen_cb, NULL);
+}
+
+// The number of callbacks seen for an event since the nth (and the last of them).
+// Only types with all the flags in type are counted; EV_NONE counts any.
+static int count_seen(int indx, EventType type = EV_NONE, int from = 0)
+{
+  int n = 0;
+
+  for (int k = from; k < nseen; k++)
+  {
+    if (seen[k].indx == indx && (type == EV_NONE || (seen[k].type & type) == type))
+      n++;
+  }
+  return n;
+}
+
+static const GestureRecord *last_seen(int indx, int from = 0)
+{
+  for (int k = nseen - 1; k >= from; k--)
+  {
+    if (seen[k].indx == indx)
+      return &seen[k];
+  }
+  return NULL;
+}
+
+// Callbacks that do nothing (the observer sees everything).
+static void tap_cb(EventType type, int indx, void *param, int x, int y) {}
+static void drag_cb(EventType type, int indx, void *param, int x, int y, int dx, int dy) {}
+static void pinch_cb(EventType type, int indx, void *param, int dx, int dy, float sx, float sy) {}
+
+// Frames of contacts, FRAME_TIME ms apart.
+#define FRAME_TIME  30
+
+static unsigned long now = 1000;
+
+static void put(TouchContact *c, int k, int id, int x, int y, int area = 10)
+{
+  c[k].id = id;
+  c[k].x = x;
+  c[k].y = y;
+  c[k].area = area;
+}
+
+static void frame(GestureDetector *d, int contacts, TouchContact *c)
+{
+  now += FRAME_TIME;
+  d->processFrame(now, contacts, c);
+}
+
+// Let go of everything, and wait long enough for taps to be forgotten.
+static void lift(GestureDetector *d)
+{
+  for (int k = 0; k < 20; k++)
+  {
+    TouchContact none[1];
+    frame(d, 0, none);
+  }
+}
+
+// Regions against polygons worked out by hand. A polygon here is closed: its
+// first point repeated at the end, as in_polygon wants.
+
+// Put the n vertices of poly through xf into moved (n + 1 points), closing it.
+static void move_polygon(const Point *poly, int n, Affine xf, Point *moved)
+{
+  xf.apply(poly, moved, n);
+  moved[n] = moved[0];
+}
+
+static bool in_poly(Point *poly, int n, int x, int y)
+{
+  return Point(x, y).in_polygon(poly, n) != 0;
+}
+
+// Whether the polygon's edge runs within reach pixels of (x, y).
+static bool near_edge(Point *poly, int n, int x, int y, int reach)
+{
+  bool in = in_poly(poly, n, x, y);
+
+  for (int v = y - reach; v <= y + reach; v++)
+  {
+    for (int u = x - reach; u <= x + reach; u++)
+    {
+      if (in_poly(poly, n, u, v) != in)
+        return true;
+    }
+  }
+  return false;
+}
+
+// Points step apart all over the screen where the tap at indx is hit and the
+// polygon isn't, or the other way round, other than within reach of its edge.
+// The number of points where the tap is hit goes in *hits, if asked for.
+static int differences(GestureDetector *d, int indx, Point *poly, int n, int step, int reach, int *hits = NULL)
+{
+  int x, y, bad = 0, nhit = 0;
+  bool hit;
+
+  for (y = 0; y < HEIGHT; y += step)
+  {
+    for (x = 0; x < WIDTH; x += step)
+    {
+      hit = d->findEvent(EV_TAP, x, y) == indx;
+      if (hit)
+        nhit++;
+      if (hit != in_poly(poly, n, x, y) && !near_edge(poly, n, x, y, reach))
+        bad++;
+    }
+  }
+  if (hits)
+    *hits = nhit;
+  return bad;
+}
+
+#endif // def TEST_H
@@ -0,0 +1,153 @@
+#include "test.h"
+
+// Affine callbacks: each callback's delta takes the previous total to the new
+// one (previous.then(*delta) is the total), so following the deltas from the
+// start ends up where the last total says, without drifting. The totals are the
+// drag's or pinch's own dx, dy and scales, with the translation unrounded. A new
+// gesture starts again from nothing.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+static bool near(const Affine &a, const Affine &b, float tol, float ttol)
+{
+  return fabs(a.a11 - b.a11) <= tol && fabs(a.a12 - b.a12) <= tol
+    && fabs(a.a21 - b.a21) <= tol && fabs(a.a22 - b.a22) <= tol
+    && fabs(a.dx - b.dx) <= ttol && fabs(a.dy - b.dy) <= ttol;
+}
+
+// What the callbacks of the current gesture have said: the last total, the
+// deltas followed from the start, and how often a delta didn't take the last
+// total to the new one.
+static Affine last_total;
+static Affine walked;
+static int ncb, broken, first_not_total;
+
+static void start(void)
+{
+  last_total = walked = Affine();
+  ncb = broken = first_not_total = 0;
+  watch(&d);
+}
+
+static void affine_cb(EventType type, int indx, void *param, const Affine *total, const Affine *delta)
+{
+  if (ncb == 0 && !near(*delta, *total, 1e-6, 1e-6))
+    first_not_total++;
+  if (!near(last_total.then(*delta), *total, 1e-4, 0.001))
+    broken++;
+  walked = walked.then(*delta);
+  last_total = *total;
+  ncb++;
+}
+
+// The total as the observer saw the callback: its unrounded translation, and
+// its scales (for a rotating pinch, the cosine and sine of its angle, scaled).
+static Affine seen_total(const GestureRecord *rec, bool rotatable)
+{
+  if (rotatable)
+    return Affine(rec->tx, rec->ty, rec->sx, -rec->sy, rec->sy, rec->sx);
+  return Affine(rec->tx, rec->ty, rec->sx, rec->sy);
+}
+
+// Check a gesture on the event at indx once it has been released.
+static void check_gesture(int indx, bool rotatable)
+{
+  CHECK(ncb > 3);
+  CHECK_EQ(ncb, count_seen(indx));
+  CHECK_EQ(broken, 0);
+  CHECK_EQ(first_not_total, 0);
+  CHECK(near(walked, last_total, 1e-4, 0.01));
+  CHECK(near(seen_total(last_seen(indx), rotatable), last_total, 1e-6, 1e-6));
+}
+
+// A drag: the totals are translations, by the drag's dx and dy.
+static void drag(void)
+{
+  int k;
+
+  start();
+  for (k = 0; k < 12; k++)
+  {
+    put(c, 0, 0, 100 + 7 * k, 100 + 3 * k);
+    frame(&d, 1, c);
+  }
+  lift(&d);
+  check_gesture(0, false);
+  CHECK(near(last_total, Affine(77, 33), 0, 0.001));
+}
+
+// A pinch pulling apart unevenly, without rotation.
+static void pinch(void)
+{
+  int k;
+
+  start();
+  for (k = 0; k < 10; k++)
+  {
+    put(c, 0, 0, 200 - 7 * k, 400 - 2 * k);
+    put(c, 1, 1, 280 + 13 * k, 460 + 9 * k);
+    frame(&d, 2, c);
+  }
+  lift(&d);
+  check_gesture(1, false);
+  CHECK(last_total.a11 > 1.5);
+  CHECK(last_total.a22 > 1.5);
+}
+
+// A pinch turning as it opens out, with rotation.
+static void rotating(void)
+{
+  int k;
+
+  start();
+  for (k = 0; k < 12; k++)
+  {
+    float a = 0.08 * k;
+    float r = 40 + 4 * k;
+
+    put(c, 0, 0, 240 + r * cos(a), 600 + r * sin(a));
+    put(c, 1, 1, 240 - r * cos(a), 600 - r * sin(a));
+    frame(&d, 2, c);
+  }
+  lift(&d);
+  check_gesture(2, true);
+  CHECK(last_total.a21 > 0.5);
+  CHECK(fabs(last_total.a12 + last_total.a21) < 1e-6);
+}
+
+// With the affine callback taken off, the pinch's own callback is made again.
+static void cleared(void)
+{
+  int k;
+
+  d.setAffineCallback(1, NULL);
+  start();
+  for (k = 0; k < 6; k++)
+  {
+    put(c, 0, 0, 200 - 10 * k, 500);
+    put(c, 1, 1, 280 + 10 * k, 500);
+    frame(&d, 2, c);
+  }
+  lift(&d);
+  CHECK(count_seen(1) > 2);
+  CHECK_EQ(ncb, 0);
+}
+
+int main()
+{
+  d.begin();
+  d.onDrag(0, 0, 480, 300, drag_cb, 0);
+  d.onPinch(0, 300, 480, 250, pinch_cb, 1);
+  d.onPinch(0, 550, 480, 250, pinch_cb, 2, NULL, true);
+  d.setAffineCallback(0, affine_cb);
+  d.setAffineCallback(1, affine_cb);
+  d.setAffineCallback(2, affine_cb);
+
+  drag();
+  pinch();
+  drag();
+  rotating();
+  cleared();
+  TEST_DONE();
+}
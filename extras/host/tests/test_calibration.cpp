@@ -0,0 +1,143 @@
+#include "test.h"
+#include "Arduino_GigaDisplayTouch.h"
+
+// The touch transform: points from the controller go through the calibration
+// and the rotation in one fixed point step. Uncalibrated, they come out where
+// the switch poll() used before put them. Calibrated, they come out where
+// that switch puts the calibrated point before it is rounded, as the point is
+// only rounded once.
+
+GestureDetector d;
+
+// The old rotation of a point from the controller to the screen, rounded to
+// the nearest pixel.
+static Point rotated(int rotation, float x, float y)
+{
+  float u = x, v = y;
+
+  switch (rotation)
+  {
+  case 1:
+    u = y;
+    v = WIDTH - 1 - x;
+    break;
+  case 2:
+    u = WIDTH - 1 - x;
+    v = HEIGHT - 1 - y;
+    break;
+  case 3:
+    u = HEIGHT - 1 - y;
+    v = x;
+    break;
+  }
+  return Point(floorf(u + 0.5f), floorf(v + 0.5f));
+}
+
+// Where a touch at (x, y) on the controller is seen, as the point a tap on
+// the whole screen is called back at.
+static Point touched(int x, int y)
+{
+  GDTpoint_t p[1];
+
+  memset(p, 0, sizeof(p));
+  p[0].x = x;
+  p[0].y = y;
+  p[0].area = 10;
+  watch(&d);
+  host_touch(1, p);
+  now = d.nextPollDue();
+  d.poll(now);
+  host_touch(0, p);
+  now = d.nextPollDue();
+  d.poll(now);
+  if (nseen == 0)
+    return Point(-1, -1);
+  return Point(seen[0].x, seen[0].y);
+}
+
+// The corners of the panel, and points scattered over it.
+#define NPOINTS 40
+
+static Point points[NPOINTS];
+
+static void make_points(void)
+{
+  points[0] = Point(0, 0);
+  points[1] = Point(WIDTH - 1, 0);
+  points[2] = Point(0, HEIGHT - 1);
+  points[3] = Point(WIDTH - 1, HEIGHT - 1);
+  randomSeed(1);
+  for (int k = 4; k < NPOINTS; k++)
+    points[k] = Point(random(0, WIDTH), random(0, HEIGHT));
+}
+
+// Each rotation, uncalibrated and calibrated, against the old switch. The
+// calibrations' scales are exact in binary, so they round the same either way.
+static void rotations(Affine cal)
+{
+  int rot, k, wrong = 0;
+
+  d.setCalibration(cal);
+  for (rot = 0; rot < 4; rot++)
+  {
+    d.setRotation(rot);
+    for (k = 0; k < NPOINTS; k++)
+    {
+      int x = points[k].x, y = points[k].y;
+      Point want = rotated(rot, cal.a11 * x + cal.a12 * y + cal.dx, cal.a21 * x + cal.a22 * y + cal.dy);
+      Point got = touched(points[k].x, points[k].y);
+
+      if (got.x != want.x || got.y != want.y)
+        wrong++;
+    }
+  }
+  CHECK_EQ(wrong, 0);
+  d.setRotation(0);
+  d.setCalibration(Affine());
+}
+
+// Three touches reported off from where they were made on the display give a
+// calibration taking them back there, in any rotation.
+static void three_points(void)
+{
+  Point display[3] = { Point(40, 40), Point(440, 60), Point(200, 760) };
+  Point reported[3];
+  Affine skew(7, -5, 1.02, 0.01, -0.02, 0.98);
+  int rot, k;
+
+  for (k = 0; k < 3; k++)
+    reported[k] = skew.apply(display[k].x, display[k].y);
+  CHECK(d.setCalibration(reported, display));
+  for (rot = 0; rot < 4; rot++)
+  {
+    d.setRotation(rot);
+    for (k = 0; k < 3; k++)
+    {
+      Point want = rotated(rot, display[k].x, display[k].y);
+      Point got = touched(reported[k].x, reported[k].y);
+
+      CHECK_EQ(got.x, want.x);
+      CHECK_EQ(got.y, want.y);
+    }
+  }
+
+  // Points in a line can't be fitted, and leave the calibration alone.
+  reported[2] = Point(reported[0].x + 2 * (reported[1].x - reported[0].x), reported[0].y + 2 * (reported[1].y - reported[0].y));
+  CHECK(!d.setCalibration(reported, display));
+  CHECK(d.getCalibration().a12 != 0);
+  d.setRotation(0);
+  d.setCalibration(Affine());
+}
+
+int main()
+{
+  d.begin();
+  d.onTap(0, 0, 0, 0, tap_cb, 1);
+  make_points();
+
+  rotations(Affine());
+  rotations(Affine(5, -3, 1.25, 0, 0, 0.75));
+  rotations(Affine(-4, 6, 1, 0.0625, -0.125, 1));
+  three_points();
+  TEST_DONE();
+}
@@ -0,0 +1,151 @@
+#include <atomic>
+#include <thread>
+#include "test.h"
+#include "Arduino_GigaDisplayTouch.h"
+
+// Capture mode: samples come from the controller's interrupt (here, another
+// thread driving the stand-in controller) while poll() processes them. None are
+// lost or reordered unless the ring is full, when they are counted as overruns;
+// and as the controller doesn't interrupt when the last contact lifts, a drag
+// is released RELEASE_TIME ms after the samples stop. Only one detector can
+// capture at a time.
+
+GestureDetector d, other;
+
+static GDTpoint_t point(int x, int y)
+{
+  GDTpoint_t p;
+
+  memset(&p, 0, sizeof(p));
+  p.x = x;
+  p.y = y;
+  p.area = 10;
+  return p;
+}
+
+// The interrupt: touch, move right 10 each sample, and stop without lifting.
+#define SAMPLES   20
+
+static std::atomic<bool> done(false);
+
+static void interrupts_thread(unsigned long start)
+{
+  for (int k = 0; k < SAMPLES; k++)
+  {
+    GDTpoint_t p = point(50 + 10 * k, 100);
+
+    host_set_millis(start + FRAME_TIME * k);
+    host_touch(1, &p);
+    host_interrupt();
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  done = true;
+}
+
+// A drag fed from another thread while poll() runs, then released by time.
+static void drag_while_polling(void)
+{
+  unsigned long start = now;
+  unsigned long last = start + FRAME_TIME * (SAMPLES - 1);
+
+  watch(&d);
+  host_set_millis(start);
+  d.beginCapture();
+  std::thread irq(interrupts_thread, start);
+  while (!done)
+    d.poll();
+  irq.join();
+  d.poll(last);
+
+  CHECK_EQ(d.captureOverruns(), 0);
+  CHECK(count_seen(1, EV_DRAG) > 2);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 0);
+  CHECK(last_seen(1) != NULL && last_seen(1)->dx == 10 * (SAMPLES - 1));
+
+  // The moves came in order.
+  int dx = 0;
+  for (int k = 0; k < nseen; k++)
+  {
+    CHECK(seen[k].dx >= dx);
+    dx = seen[k].dx;
+  }
+
+  // Still held just short of RELEASE_TIME after the last sample; released at it.
+  d.poll(last + RELEASE_TIME - 1);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 0);
+  d.poll(last + RELEASE_TIME);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  CHECK(last_seen(1) != NULL && last_seen(1)->dx == 10 * (SAMPLES - 1));
+  d.endCapture();
+  now = last + 1000;
+}
+
+// Samples that arrive while the ring is full are dropped and counted, and
+// the ones already queued are processed.
+static void overrun(void)
+{
+  unsigned long start = now;
+
+  watch(&d);
+  host_set_millis(start);
+  d.beginCapture();
+  std::thread irq([start]()
+  {
+    for (int k = 0; k < CAPTURE_SIZE + 5; k++)
+    {
+      GDTpoint_t p = point(50 + 10 * k, 100);
+
+      host_set_millis(start + FRAME_TIME * k);
+      host_touch(1, &p);
+      host_interrupt();
+    }
+  });
+  irq.join();
+  CHECK_EQ(d.captureOverruns(), 5);
+
+  unsigned long last = start + FRAME_TIME * (CAPTURE_SIZE - 1);
+  d.poll(last);
+  CHECK(last_seen(1) != NULL && last_seen(1)->dx == 10 * (CAPTURE_SIZE - 1));
+  d.poll(last + RELEASE_TIME);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  d.endCapture();
+  now = last + 1000;
+}
+
+// A second detector can't take the interrupt while the first is capturing,
+// and the first keeps its samples; it can once the first has stopped.
+static void second(void)
+{
+  watch(&d);
+  CHECK(d.beginCapture());
+  CHECK(!other.beginCapture());
+  other.endCapture();
+  for (int k = 0; k < CAPTURE_SIZE; k++)
+  {
+    GDTpoint_t p = point(50 + 10 * k, 100);
+
+    host_set_millis(now + FRAME_TIME * k);
+    host_touch(1, &p);
+    host_interrupt();
+  }
+  now += FRAME_TIME * (CAPTURE_SIZE - 1);
+  d.poll(now);
+  d.poll(now + RELEASE_TIME);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  CHECK(last_seen(1) != NULL && last_seen(1)->dx == 10 * (CAPTURE_SIZE - 1));
+  d.endCapture();
+  CHECK(other.beginCapture());
+  CHECK(!d.beginCapture());
+  other.endCapture();
+  now += RELEASE_TIME;
+}
+
+int main()
+{
+  d.begin();
+  d.onDrag(0, 0, 480, 400, drag_cb, 1);
+  drag_while_polling();
+  overrun();
+  second();
+  TEST_DONE();
+}
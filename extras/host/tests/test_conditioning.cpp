@@ -0,0 +1,146 @@
+#include "test.h"
+
+// Input conditioning: a tap has to move past the touch slop to become a drag,
+// the One Euro filter holds a jittering contact still without lagging far
+// behind one that is moving, and palms are ignored. Each is counted in the
+// input stats.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+static InputStats stats(void)
+{
+  InputStats s;
+
+  d.getInputStats(&s);
+  return s;
+}
+
+// Hold a contact for n frames, at x + dx[k % 4].
+static void hold(int id, int x, int y, int n, const int *dx, int area = 10)
+{
+  for (int k = 0; k < n; k++)
+  {
+    put(c, 0, id, x + dx[k % 4], y, area);
+    frame(&d, 1, c);
+  }
+}
+
+// Moving within the slop leaves a tap a tap, however long it is held; moving
+// past it makes it a drag.
+static void slop(void)
+{
+  static const int wobble[4] = { 0, 3, 6, 3 };
+  int k;
+
+  d.setTouchSlop(10);
+  d.resetInputStats();
+  watch(&d);
+  hold(0, 100, 100, 12, wobble);
+  CHECK_EQ(count_seen(1), 0);
+  CHECK_EQ(stats().slop_samples, 11);
+  lift(&d);
+  CHECK_EQ(count_seen(2, EV_TAP | EV_RELEASED), 1);
+  CHECK_EQ(count_seen(1), 0);
+
+  watch(&d);
+  for (k = 0; k < 12; k++)
+  {
+    put(c, 0, 1, 100 + 4 * k, 300);
+    frame(&d, 1, c);
+  }
+  CHECK(count_seen(1, EV_DRAG) > 0);
+  CHECK_EQ(last_seen(1)->dx, 44);
+  CHECK_EQ(stats().slop_samples, 13);
+  lift(&d);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  d.setTouchSlop(0);
+}
+
+// With the filter, a contact jittering by a pixel either way stays where it
+// landed, so it doesn't become a drag; without it, it does.
+static void jitter(void)
+{
+  static const int jitter[4] = { 0, 1, 0, -1 };
+
+  d.setFilter(1.0, 0);
+  d.resetInputStats();
+  watch(&d);
+  hold(2, 200, 500, 20, jitter);
+  CHECK_EQ(count_seen(1), 0);
+  CHECK_EQ(stats().jitter_samples, 10);
+  lift(&d);
+  CHECK_EQ(count_seen(2, EV_TAP | EV_RELEASED), 1);
+
+  d.setFilter(0);
+  watch(&d);
+  hold(3, 200, 500, 20, jitter);
+  CHECK(count_seen(1, EV_DRAG) > 0);
+  lift(&d);
+  CHECK_EQ(stats().jitter_samples, 10);
+}
+
+// A contact moving at 10 pixels a frame: with no beta the filter's cutoff stays
+// low and the drag lags well behind; with beta it rises with the speed, and the
+// drag keeps up.
+static int lag(float beta)
+{
+  int k, behind;
+
+  d.setFilter(1.0, beta);
+  watch(&d);
+  for (k = 0; k < 16; k++)
+  {
+    put(c, 0, 4, 50 + 10 * k, 600);
+    frame(&d, 1, c);
+  }
+  behind = 150 - last_seen(1)->dx;
+  lift(&d);
+  d.setFilter(0);
+  return behind;
+}
+
+// Contacts larger than the palm area are left out. A drag whose contact
+// becomes a palm is released.
+static void palm(void)
+{
+  static const int still[4] = { 0, 0, 0, 0 };
+  int k;
+
+  d.setPalmArea(100);
+  d.resetInputStats();
+  watch(&d);
+  hold(5, 300, 300, 10, still, 200);
+  CHECK_EQ(nseen, 0);
+  CHECK_EQ(stats().palm_contacts, 10);
+  lift(&d);
+
+  for (k = 0; k < 10; k++)
+  {
+    put(c, 0, 6, 100 + 5 * k, 300, k < 8 ? 50 : 150);
+    frame(&d, 1, c);
+  }
+  CHECK_EQ(count_seen(1, EV_DRAG | EV_RELEASED), 1);
+  CHECK_EQ(last_seen(1)->dx, 35);
+  CHECK_EQ(stats().palm_contacts, 12);
+  lift(&d);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  d.setPalmArea(0);
+
+  d.resetInputStats();
+  CHECK_EQ(stats().palm_contacts, 0);
+}
+
+int main()
+{
+  d.begin();
+  d.onDrag(0, 0, 480, 800, drag_cb, 1);
+  d.onTap(0, 0, 480, 800, tap_cb, 2);
+
+  slop();
+  jitter();
+  CHECK(lag(0) > 30);
+  CHECK(lag(0.1) < 10);
+  palm();
+  TEST_DONE();
+}
@@ -0,0 +1,71 @@
+#include "test.h"
+
+// Damage: each drag callback's damage is the bounding box of its region where
+// it was last shown and where the drag puts it now. The drag moves the region
+// from where transformRegion() had put it when the drag began, within its node.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+// Drag from (x, y) right by 5 pixels a frame, and check the damage of each
+// update against a region whose box is (xmin, ymin, xmax, ymax) before the drag.
+static void drag_region(int indx, int x, int y, int xmin, int ymin, int xmax, int ymax)
+{
+  int k, n, bad = 0;
+  const GestureRecord *rec;
+
+  watch(&d);
+  for (k = 0; k < 12; k++)
+  {
+    put(c, 0, 0, x + 5 * k, y);
+    frame(&d, 1, c);
+  }
+  lift(&d);
+
+  n = 0;
+  for (k = 0; k < nseen; k++)
+  {
+    rec = &seen[k];
+    if (rec->indx != indx)
+      continue;
+    if (rec->damage.xmax != xmax + rec->dx || rec->damage.ymin != ymin || rec->damage.ymax != ymax)
+      bad++;
+    if (rec->damage.xmin < xmin || rec->damage.xmin > xmin + rec->dx)
+      bad++;
+    n++;
+  }
+  CHECK(n > 2);
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(last_seen(indx)->dx, 55);
+}
+
+// Moving the region along with the totals called back, as an app would,
+// doesn't move the damage twice.
+static void follow_cb(EventType type, int indx, void *param, int x, int y, int dx, int dy)
+{
+  d.transformRegion(indx, 200 + dx, 0);
+}
+
+int main()
+{
+  d.begin();
+
+  d.onDrag(20, 20, 100, 100, drag_cb, 1);
+  drag_region(1, 50, 50, 20, 20, 120, 120);
+
+  d.transformRegion(1, 200, 0);
+  drag_region(1, 250, 50, 220, 20, 320, 120);
+
+  d.onDrag(20, 200, 100, 100, follow_cb, 2);
+  d.transformRegion(2, 200, 0);
+  drag_region(2, 250, 250, 220, 200, 320, 300);
+
+  // Scaled by its own transform, then moved down by its node.
+  d.onDrag(20, 20, 100, 100, drag_cb, 3);
+  d.setNode(0, -1);
+  d.transformNode(0, 0, 300);
+  d.attachRegion(3, 0);
+  d.transformRegion(3, 100, 0, 2, 2);
+  drag_region(3, 200, 400, 140, 340, 340, 540);
+  TEST_DONE();
+}
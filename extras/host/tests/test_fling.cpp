@@ -0,0 +1,101 @@
+#include "test.h"
+
+// Inertia: a drag released while moving carries on, slowing down as
+// exp(-t / FLING_TIME_CONSTANT), and the callbacks say how fast it is going.
+// A new touch stops it where it is.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+// Drag right at 10 pixels a frame, held past SWIPE_TIME so it isn't a swipe,
+// and let go.
+#define SPEED   (10.0 / FRAME_TIME)
+
+static void fling_drag(int id)
+{
+  int k;
+
+  for (k = 0; k < 10; k++)
+  {
+    put(c, 0, id, 100 + 10 * k, 100);
+    frame(&d, 1, c);
+  }
+  frame(&d, 0, c);
+}
+
+// Let it run down (lift() doesn't wait long enough).
+static void run_down(void)
+{
+  for (int k = 0; k < 40; k++)
+    frame(&d, 0, c);
+}
+
+// It slows down each frame by the same factor, and stops when it is going
+// slower than FLING_MIN_SPEED, (SPEED - FLING_MIN_SPEED) * FLING_TIME_CONSTANT
+// past where it was let go.
+static void decay(void)
+{
+  int k, from, released_dx;
+  float ratio = exp(-(float)FRAME_TIME / FLING_TIME_CONSTANT);
+
+  watch(&d);
+  fling_drag(0);
+  from = nseen;
+  released_dx = last_seen(1)->dx;
+  CHECK_EQ(count_seen(1, EV_INERTIA), 0);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 0);
+  CHECK(fabs(last_seen(1)->vx - SPEED) < 0.01);
+
+  run_down();
+  CHECK(count_seen(1, EV_INERTIA, from) > 10);
+  CHECK_EQ(count_seen(1, EV_RELEASED, from), 1);
+  CHECK(fabs(last_seen(1)->dx - released_dx - (SPEED - FLING_MIN_SPEED) * FLING_TIME_CONSTANT) < 5);
+  CHECK(last_seen(1)->vx < FLING_MIN_SPEED);
+  CHECK_EQ(last_seen(1)->dy, 0);
+
+  // Each update reports the velocity decayed since the last, and the
+  // acceleration slowing it.
+  CHECK(seen[from].type & EV_INERTIA);
+  CHECK(fabs(seen[from].vx - SPEED * ratio) < 0.01);
+  for (k = from + 1; k < nseen; k++)
+  {
+    if (!(seen[k].type & EV_INERTIA) || !(seen[k - 1].type & EV_INERTIA))
+      continue;
+    CHECK(fabs(seen[k].vx - seen[k - 1].vx * ratio) < 0.001);
+    CHECK(fabs(seen[k].ax + seen[k].vx / FLING_TIME_CONSTANT) < 0.0001);
+    CHECK(seen[k].dx > seen[k - 1].dx);
+  }
+}
+
+// A touch landing stops the fling where it is, released and no longer moving.
+static void stopped(void)
+{
+  int k, stop_dx;
+
+  watch(&d);
+  fling_drag(1);
+  frame(&d, 0, c);
+  frame(&d, 0, c);
+  CHECK_EQ(count_seen(1, EV_INERTIA), 2);
+  stop_dx = last_seen(1)->dx;
+
+  put(c, 0, 2, 400, 700);
+  frame(&d, 1, c);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  CHECK(last_seen(1)->dx - stop_dx < 10);
+  CHECK_EQ(last_seen(1)->vx, 0);
+  for (k = 0; k < 5; k++)
+    frame(&d, 1, c);
+  lift(&d);
+  CHECK_EQ(count_seen(1, EV_INERTIA), 2);
+}
+
+int main()
+{
+  d.begin();
+  d.onDrag(0, 0, 480, 400, drag_cb, 1, NULL, CO_NONE, 3, true);
+
+  decay();
+  stopped();
+  TEST_DONE();
+}
@@ -0,0 +1,120 @@
+#include "test.h"
+
+// The hit map: whatever the regions and however they change, finding the
+// event under a point gives the same answer with the map as without it,
+// including for regions that don't fit in its entries, regions with no
+// points, and after the screen is rotated.
+
+GestureDetector d;
+
+// Compare findEvent with and without the map at points all over the screen
+// (and a little off it). Returns the number of points where they differ.
+static int differences(void)
+{
+  int x, y, with_map, bad = 0;
+
+  for (y = -8; y < HEIGHT + 8; y += 7)
+  {
+    for (x = -8; x < HEIGHT + 8; x += 7)
+    {
+      d.setHitMap(true);
+      with_map = d.findEvent(EV_TAP, x, y);
+      d.setHitMap(false);
+      if (d.findEvent(EV_TAP, x, y) != with_map)
+        bad++;
+    }
+  }
+  return bad;
+}
+
+// Points found with the map kept up to date as regions change, against the
+// linear scan.
+static int differences_kept(void)
+{
+  int x, y, bad = 0;
+  int found[(HEIGHT + 16) / 7 + 1][(HEIGHT + 16) / 7 + 1];
+
+  for (y = -8; y < HEIGHT + 8; y += 7)
+  {
+    for (x = -8; x < HEIGHT + 8; x += 7)
+      found[(y + 8) / 7][(x + 8) / 7] = d.findEvent(EV_TAP, x, y);
+  }
+  d.setHitMap(false);
+  for (y = -8; y < HEIGHT + 8; y += 7)
+  {
+    for (x = -8; x < HEIGHT + 8; x += 7)
+    {
+      if (d.findEvent(EV_TAP, x, y) != found[(y + 8) / 7][(x + 8) / 7])
+        bad++;
+    }
+  }
+  d.setHitMap(true);
+  return bad;
+}
+
+// Random taps all over the screen, in every event.
+static void scattered(void)
+{
+  randomSeed(1);
+  for (int i = 0; i < MAX_EVENTS; i++)
+  {
+    int w = random(20, 120);
+    int h = random(20, 120);
+
+    d.onTap(random(-20, WIDTH), random(-20, HEIGHT), w, h, tap_cb, i);
+  }
+  CHECK_EQ(differences(), 0);
+}
+
+// Changing regions while the map is on keeps it up to date.
+static void changes(void)
+{
+  d.setHitMap(true);
+  d.transformRegion(MAX_EVENTS - 1, 100, 50);
+  d.transformRegion(MAX_EVENTS - 2, 200, 100, 0.5, 0.5);
+  d.cancelEvent(MAX_EVENTS - 3);
+  d.onTap(10, 10, 60, 60, tap_cb, MAX_EVENTS - 4);
+  d.shareRegion(MAX_EVENTS - 5, MAX_EVENTS - 6);
+  d.transformRegion(MAX_EVENTS - 6, -40, 30);
+  d.setNode(0, -1);
+  d.attachRegion(MAX_EVENTS - 7, 0);
+  d.transformNode(0, 60, -20);
+  CHECK_EQ(differences_kept(), 0);
+}
+
+// Regions too big for the entries left, and one with no points, are tested
+// everywhere, and taking them out again frees the entries for others.
+static void overflow(void)
+{
+  d.setHitMap(true);
+  for (int i = 0; i < 4; i++)
+    d.onTap(0, 0, WIDTH, HEIGHT, tap_cb, i);
+  d.onTap(NULL, 0, tap_cb, 4);
+  CHECK_EQ(differences_kept(), 0);
+  for (int i = 0; i < 5; i++)
+    d.cancelEvent(i);
+  d.onTap(300, 300, 50, 50, tap_cb, 0);
+  CHECK_EQ(differences_kept(), 0);
+}
+
+// Rotated, the map runs across the other way.
+static void rotated(void)
+{
+  d.setHitMap(true);
+  d.setRotation(1);
+  d.transformRegion(MAX_EVENTS - 8, 300, -100);
+  CHECK_EQ(differences_kept(), 0);
+  CHECK_EQ(differences(), 0);
+  d.setRotation(0);
+}
+
+int main()
+{
+  d.begin();
+
+  scattered();
+  changes();
+  overflow();
+  rotated();
+  TEST_DONE();
+}
@@ -0,0 +1,150 @@
+#include "test.h"
+
+// Layers: a modal layer suspends the events below it, and popping it cancels
+// only its own events. Registering an event again keeps it in its layer. A
+// gesture under a layer as it is pushed is released, once, where it has got to.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+static void tap(int x, int y)
+{
+  put(c, 0, 0, x, y);
+  frame(&d, 1, c);
+  frame(&d, 1, c);
+  lift(&d);
+}
+
+// A tap held as a dialog is pushed over it is released at once, and isn't
+// counted towards a multi-tap.
+static void held_tap(void)
+{
+  int k;
+
+  d.onTap(0, 0, 480, 400, tap_cb, 2);
+  watch(&d);
+  put(c, 0, 1, 100, 100);
+  for (k = 0; k < 3; k++)
+    frame(&d, 1, c);
+  CHECK_EQ(d.pushLayer(true), 1);
+  for (k = 0; k < 3; k++)
+    frame(&d, 1, c);
+  CHECK_EQ(nseen, 2);
+  CHECK_EQ(count_seen(2, EV_TAP | EV_RELEASED), 1);
+  d.popLayer();
+  lift(&d);
+  CHECK_EQ(nseen, 2);
+  tap(100, 100);
+  CHECK_EQ(EV_TAP_COUNT(last_seen(2)->type), 1);
+}
+
+#if GD_USE_DRAG
+// A drag under a dialog pushed while it moves is released where it had got
+// to, and hears no more, even once the dialog has gone; and a drag carrying on
+// by inertia stops where it is.
+static void moving(void)
+{
+  TouchContact none[1];
+  int k;
+
+  d.onDrag(0, 400, 480, 400, drag_cb, 3, NULL, CO_NONE, 3, true);
+  watch(&d);
+  for (k = 0; k < 10; k++)
+  {
+    put(c, 0, 2, 100 + 10 * k, 600);
+    frame(&d, 1, c);
+  }
+  CHECK(count_seen(3, EV_DRAG) > 0);
+  CHECK_EQ(count_seen(3, EV_RELEASED), 0);
+  CHECK_EQ(d.pushLayer(true), 1);
+  for (k = 10; k < 15; k++)
+  {
+    put(c, 0, 2, 100 + 10 * k, 600);
+    frame(&d, 1, c);
+  }
+  CHECK_EQ(count_seen(3, EV_DRAG | EV_RELEASED), 1);
+  CHECK_EQ(last_seen(3)->dx, 90);
+  d.popLayer();
+  for (k = 15; k < 20; k++)
+  {
+    put(c, 0, 2, 100 + 10 * k, 600);
+    frame(&d, 1, c);
+  }
+  lift(&d);
+  CHECK_EQ(count_seen(3, EV_RELEASED), 1);
+  CHECK(last_seen(3)->type & EV_RELEASED);
+
+  watch(&d);
+  for (k = 0; k < 10; k++)
+  {
+    put(c, 0, 3, 100 + 20 * k, 600);
+    frame(&d, 1, c);
+  }
+  frame(&d, 0, none);
+  frame(&d, 0, none);
+  CHECK(count_seen(3, EV_DRAG | EV_INERTIA) > 0);
+  CHECK_EQ(count_seen(3, EV_RELEASED), 0);
+  CHECK_EQ(d.pushLayer(true), 1);
+  lift(&d);
+  CHECK_EQ(count_seen(3, EV_RELEASED), 1);
+  CHECK(last_seen(3)->type & EV_RELEASED);
+  d.popLayer();
+  d.cancelEvent(3);
+}
+#endif
+
+int main()
+{
+  d.begin();
+  watch(&d);
+  d.onTap(0, 0, 480, 400, tap_cb, 2);
+  tap(100, 100);
+  CHECK_EQ(count_seen(2, EV_RELEASED), 1);
+
+  // A dialog over the top half, with a button in it.
+  CHECK_EQ(d.pushLayer(true), 1);
+  d.onTap(100, 100, 200, 100, tap_cb, 5);
+  watch(&d);
+  tap(150, 150);
+  CHECK_EQ(count_seen(5, EV_RELEASED), 1);
+  CHECK_EQ(count_seen(2), 0);
+
+  // Moving the background event while the dialog is up doesn't bring it
+  // up through the dialog.
+  d.onTap(0, 0, 480, 300, tap_cb, 2);
+  watch(&d);
+  tap(20, 20);
+  tap(150, 150);
+  CHECK_EQ(count_seen(2), 0);
+  CHECK_EQ(count_seen(5, EV_RELEASED), 1);
+
+  // An event in the dialog registered again stays in the dialog.
+  d.onTap(100, 100, 200, 50, tap_cb, 5);
+
+  // Popping the dialog cancels its button, not the background event.
+  d.popLayer();
+  CHECK(d.isEventRegistered(2));
+  CHECK(!d.isEventRegistered(5));
+  watch(&d);
+  tap(20, 20);
+  CHECK_EQ(count_seen(2, EV_RELEASED), 1);
+  CHECK(last_seen(2) != NULL && last_seen(2)->x == 20);
+
+  // A disabled layer's events are kept, but not hit.
+  CHECK_EQ(d.pushLayer(false), 1);
+  d.onTap(0, 500, 100, 100, tap_cb, 7);
+  d.enableLayer(1, false);
+  watch(&d);
+  tap(50, 550);
+  CHECK_EQ(count_seen(7), 0);
+  d.enableLayer(1, true);
+  tap(50, 550);
+  CHECK_EQ(count_seen(7, EV_RELEASED), 1);
+  d.popLayer();
+
+  held_tap();
+#if GD_USE_DRAG
+  moving();
+#endif
+  TEST_DONE();
+}
@@ -0,0 +1,136 @@
+#include "test.h"
+
+// Multi-taps: each tap is called back at once with its count, which goes up
+// for a tap close enough in time and place to the last one in its region. A
+// long press ends the run. A region confirming its taps is only called back
+// once, with the final count, when the time for another has run out.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+// A touch at (x, y) for n frames, then gap frames with nothing touching.
+static void press(int x, int y, int n, int gap)
+{
+  TouchContact none[1];
+  int k;
+
+  put(c, 0, 0, x, y);
+  for (k = 0; k < n; k++)
+    frame(&d, 1, c);
+  for (k = 0; k < gap; k++)
+    frame(&d, 0, none);
+}
+
+static void tap(int x, int y, int gap = 3)
+{
+  press(x, y, 2, gap);
+}
+
+// The count of the nth callback seen.
+static int count_of(int n)
+{
+  return EV_TAP_COUNT(seen[n].type);
+}
+
+// Three taps in a row count 1, 2, 3, each known as it lands.
+static void counts(void)
+{
+  watch(&d);
+  tap(100, 100);
+  press(102, 98, 1, 0);
+  CHECK_EQ(nseen, 3);
+  CHECK_EQ(seen[2].type, EV_TAP | ((2 - 1) << 12));
+  press(102, 98, 1, 3);
+  tap(99, 101);
+  CHECK_EQ(nseen, 6);
+  CHECK_EQ(count_of(0), 1);
+  CHECK_EQ(count_of(1), 1);
+  CHECK_EQ(count_of(3), 2);
+  CHECK_EQ(count_of(4), 3);
+  CHECK_EQ(count_of(5), 3);
+  CHECK(seen[5].type & EV_RELEASED);
+  lift(&d);
+}
+
+// A tap too long after the last, or too far from it, starts again; setMultiTap
+// allows more of either.
+static void too_late_or_far(void)
+{
+  watch(&d);
+  tap(100, 100, 12);
+  tap(100, 100);
+  tap(140, 100);
+  CHECK_EQ(nseen, 6);
+  CHECK_EQ(count_of(3), 1);
+  CHECK_EQ(count_of(5), 1);
+  lift(&d);
+
+  d.setMultiTap(600, 60);
+  watch(&d);
+  tap(100, 100, 12);
+  tap(140, 100);
+  CHECK_EQ(count_of(3), 2);
+  lift(&d);
+  d.setMultiTap(MULTI_TAP_TIME, MULTI_TAP_DISTANCE);
+}
+
+// A long press carries the count it landed with, and ends the run.
+static void long_press(void)
+{
+  int k;
+
+  watch(&d);
+  tap(100, 100);
+  press(100, 100, 20, 3);
+  tap(100, 100);
+  CHECK_EQ(count_seen(2, EV_TAP | EV_LONG_PRESS | EV_RELEASED), 1);
+  CHECK_EQ(EV_TAP_COUNT(last_seen(2, 2)->type), 1);
+  for (k = 0; k < nseen; k++)
+  {
+    if (seen[k].type & EV_LONG_PRESS)
+      CHECK_EQ(count_of(k), 2);
+  }
+  lift(&d);
+}
+
+// A confirming region hears nothing until the run is over, and then only the
+// release with the final count. Turning confirmation off sends a waiting tap.
+static void confirmed(void)
+{
+  TouchContact none[1];
+  int k;
+
+  d.confirmTaps(3, true);
+  watch(&d);
+  tap(300, 600);
+  tap(300, 600);
+  CHECK_EQ(nseen, 0);
+  for (k = 0; k < 20 && nseen == 0; k++)
+    frame(&d, 0, none);
+  CHECK_EQ(k, MULTI_TAP_TIME / FRAME_TIME + 1 - 3);   // the first frame past it, less tap()'s gap
+  CHECK_EQ(nseen, 1);
+  CHECK_EQ(seen[0].type, EV_TAP | EV_RELEASED | ((2 - 1) << 12));
+  CHECK_EQ(seen[0].x, 300);
+
+  watch(&d);
+  tap(300, 600);
+  CHECK_EQ(nseen, 0);
+  d.confirmTaps(3, false);
+  CHECK_EQ(nseen, 1);
+  CHECK_EQ(seen[0].type, EV_TAP | EV_RELEASED);
+  lift(&d);
+  CHECK_EQ(nseen, 1);
+}
+
+int main()
+{
+  d.begin();
+  d.onTap(0, 0, 480, 400, tap_cb, 2);
+  d.onTap(0, 400, 480, 400, tap_cb, 3);
+
+  counts();
+  too_late_or_far();
+  long_press();
+  confirmed();
+  TEST_DONE();
+}
@@ -0,0 +1,106 @@
+#include "test.h"
+
+// Nodes: a region attached to a node, under other nodes, is hit where its
+// polygon would be with each vertex put through its own transform, then its
+// node's, then each parent's in turn, apart from a pixel's rounding at its
+// edges. Moving a node moves everything under it; nodes can't be put under
+// themselves; detaching a region, or registering it again, takes it off.
+
+GestureDetector d;
+
+// A triangle and a square.
+static Point triangle[4] = { Point(50, 50), Point(150, 60), Point(80, 140), Point(50, 50) };
+static Point square[5] = { Point(200, 50), Point(260, 50), Point(260, 110), Point(200, 110), Point(200, 50) };
+
+// Points where the event at indx and the polygon with each vertex put through
+// xf disagree, other than next to its edges.
+static int differences(int indx, const Point *poly, int n, Affine xf, int *hits)
+{
+  Point moved[5];
+
+  move_polygon(poly, n, xf, moved);
+  return differences(&d, indx, moved, n, 3, 1, hits);
+}
+
+// The triangle's own transform.
+static Affine own(10, 20, 1.2, 0.8);
+
+// Node 1 under node 0, with the triangle on node 1 and the square on node 0;
+// each moved in turn, and everything checked after each move.
+static void nested(void)
+{
+  Affine n0(40, 300, 0.707, -0.707, 0.707, 0.707);
+  Affine n1(-30, 15, 1.5, 1.5);
+  int hits;
+
+  d.transformRegion(0, own);
+  CHECK(d.setNode(0, -1));
+  CHECK(d.setNode(1, 0));
+  d.attachRegion(0, 1);
+  d.attachRegion(1, 0);
+
+  d.transformNode(0, n0);
+  CHECK_EQ(differences(0, triangle, 3, own.then(n0), &hits), 0);
+  CHECK_EQ(differences(1, square, 4, n0, &hits), 0);
+  CHECK(hits > 100);
+
+  d.transformNode(1, n1);
+  CHECK_EQ(differences(0, triangle, 3, own.then(n1).then(n0), &hits), 0);
+  CHECK(hits > 100);
+  CHECK_EQ(differences(1, square, 4, n0, &hits), 0);
+
+  n0 = Affine(100, -20);
+  d.transformNode(0, n0);
+  CHECK_EQ(differences(0, triangle, 3, own.then(n1).then(n0), &hits), 0);
+  CHECK_EQ(differences(1, square, 4, n0, &hits), 0);
+  CHECK(hits > 100);
+
+  // A new transform for the region itself goes under its nodes' too.
+  own = Affine(0, 40);
+  d.transformRegion(0, own);
+  CHECK_EQ(differences(0, triangle, 3, own.then(n1).then(n0), &hits), 0);
+  CHECK(hits > 100);
+}
+
+// A node can't go under itself or its children, and a node transform that
+// can't be undone is ignored.
+static void loops(void)
+{
+  int hits;
+
+  CHECK(!d.setNode(0, 1));
+  CHECK(!d.setNode(1, 1));
+  CHECK(!d.setNode(MAX_NODES, -1));
+  d.transformNode(0, 0, 0, 0, 0);
+  CHECK_EQ(differences(1, square, 4, Affine(100, -20), &hits), 0);
+  CHECK(hits > 100);
+}
+
+// Detached, the square is back where its own transform puts it; registered
+// again, the triangle is back where it started.
+static void detached(void)
+{
+  int hits;
+
+  d.attachRegion(1, -1);
+  CHECK_EQ(differences(1, square, 4, Affine(), &hits), 0);
+  CHECK(hits > 100);
+
+  d.onTap(triangle, 3, tap_cb, 0);
+  CHECK_EQ(differences(0, triangle, 3, Affine(), &hits), 0);
+  CHECK(hits > 100);
+  d.transformNode(1, 50, 50);
+  CHECK_EQ(differences(0, triangle, 3, Affine(), &hits), 0);
+}
+
+int main()
+{
+  d.begin();
+  d.onTap(triangle, 3, tap_cb, 0);
+  d.onTap(square, 4, tap_cb, 1);
+
+  nested();
+  loops();
+  detached();
+  TEST_DONE();
+}
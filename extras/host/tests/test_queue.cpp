@@ -0,0 +1,105 @@
+#include <atomic>
+#include <thread>
+#include "test.h"
+
+// Queued mode, with poll() and dispatch() in different threads: every callback
+// sees the damage of its own update, even when dispatch() falls behind and
+// updates are dropped, and every gesture is released. The velocity goes with
+// the callback in the same way.
+
+GestureDetector d;
+
+// Two drag regions, far apart, dragged at once: 1 to the right and 2 down.
+#define GESTURES  300
+#define STEPS     12
+#define STEP      5
+
+static std::atomic<bool> done(false);
+static std::atomic<int> releases[3];
+static int updates[3], bad_damage[3], bad_motion[3];
+
+static void check_cb(EventType type, int indx, void *param, int x, int y, int dx, int dy)
+{
+  DamageRect r;
+  float vx, vy, speed = (float)STEP / FRAME_TIME;
+
+  // Each region is dragged at a steady speed.
+  d.getVelocity(&vx, &vy);
+  if (indx == 1 ? fabs(vx - speed) > 0.01 || fabs(vy) > 0.01 : fabs(vx) > 0.01 || fabs(vy - speed) > 0.01)
+    bad_motion[indx]++;
+
+  if (!d.getDamage(&r))
+  {
+    bad_damage[indx]++;
+    return;
+  }
+
+  // The damage takes in where the region is now, and nothing of the other one.
+  if (indx == 1)
+  {
+    if (r.xmin > 20 + dx || r.xmax < 120 + dx || r.ymin != 20 || r.ymax != 120)
+      bad_damage[indx]++;
+  }
+  else
+  {
+    if (r.ymin > 300 + dy || r.ymax < 400 + dy || r.xmin != 300 || r.xmax != 400)
+      bad_damage[indx]++;
+  }
+  if (type & EV_RELEASED)
+    releases[indx]++;
+  else
+    updates[indx]++;
+}
+
+static void poll_thread(void)
+{
+  TouchContact c[MAX_CONTACTS];
+
+  for (int g = 0; g < GESTURES; g++)
+  {
+    for (int k = 0; k < STEPS; k++)
+    {
+      put(c, 0, 0, 70 + STEP * k, 70);
+      put(c, 1, 1, 350, 350 + STEP * k);
+      frame(&d, 2, c);
+    }
+    lift(&d);
+
+    // Frames come much faster than they would from the screen, so let the
+    // releases through before starting again (the updates may be dropped).
+    while (releases[1] <= g || releases[2] <= g)
+      std::this_thread::yield();
+  }
+  done = true;
+}
+
+static void dispatch_thread(void)
+{
+  while (!done)
+    d.dispatch();
+  d.dispatch();
+}
+
+int main()
+{
+  d.begin();
+  d.onDrag(20, 20, 100, 100, check_cb, 1);
+  d.onDrag(300, 300, 100, 100, check_cb, 2);
+  d.setQueued(true);
+
+  std::thread poller(poll_thread);
+  std::thread dispatcher(dispatch_thread);
+  poller.join();
+  dispatcher.join();
+
+  CHECK_EQ(bad_damage[1], 0);
+  CHECK_EQ(bad_damage[2], 0);
+  CHECK_EQ(bad_motion[1], 0);
+  CHECK_EQ(bad_motion[2], 0);
+  CHECK_EQ(releases[1], GESTURES);
+  CHECK_EQ(releases[2], GESTURES);
+  CHECK_EQ(d.queueDrops() + updates[1] + updates[2], GESTURES * 2 * (STEPS - 6));
+  CHECK(updates[1] > 0);
+  CHECK(updates[2] > 0);
+  TEST_DONE();
+}
@@ -0,0 +1,144 @@
+#include "test.h"
+
+// The app's own recognisers: one wanting two fingers takes them when they land,
+// together or one after the other, while a drag elsewhere carries on, and
+// removing it while it has them leaves them to nobody until they lift.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+// A two-finger recogniser, counting what it is given.
+static int frames = 0, last_contacts = 0, cancels = 0;
+
+static int two_bid(void *param, unsigned long time, uint8_t contacts, const TouchContact *c)
+{
+  return contacts == 2 ? 10 : 0;
+}
+
+static void two_frame(void *param, unsigned long time, uint8_t contacts, const TouchContact *c)
+{
+  frames++;
+  last_contacts = contacts;
+}
+
+static void two_cancel(void *param, unsigned long time)
+{
+  cancels++;
+}
+
+static void reset(void)
+{
+  frames = last_contacts = cancels = 0;
+}
+
+// Two fingers landing together go to the recogniser, and a drag already
+// down (held past SWIPE_TIME, so no longer a tap) goes on as it was.
+static void beside_drag(void)
+{
+  int k;
+
+  watch(&d);
+  reset();
+  for (k = 0; k < 8; k++)
+  {
+    put(c, 0, 0, 50 + 5 * k, 100);
+    frame(&d, 1, c);
+  }
+  for (k = 8; k < 14; k++)
+  {
+    put(c, 0, 0, 50 + 5 * k, 100);
+    put(c, 1, 1, 300, 500 + 5 * k);
+    put(c, 2, 2, 380, 500 + 5 * k);
+    frame(&d, 3, c);
+  }
+  CHECK_EQ(frames, 6);
+  CHECK_EQ(last_contacts, 2);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 0);
+  CHECK_EQ(last_seen(1)->dx, 65);
+  CHECK_EQ(count_seen(2), 0);
+
+  put(c, 0, 0, 120, 100);
+  frame(&d, 1, c);
+  CHECK_EQ(frames, 7);
+  CHECK_EQ(last_contacts, 0);
+  CHECK_EQ(last_seen(1)->dx, 70);
+  lift(&d);
+  CHECK_EQ(frames, 7);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  CHECK_EQ(cancels, 0);
+}
+
+// A second finger landing takes the first from a tap, which is called back as
+// released then and not again when it lifts.
+static void after_tap(void)
+{
+  int k;
+
+  watch(&d);
+  reset();
+  put(c, 0, 3, 300, 100);
+  frame(&d, 1, c);
+  frame(&d, 1, c);
+  CHECK_EQ(frames, 0);
+  CHECK_EQ(count_seen(2, EV_TAP), 1);
+  for (k = 0; k < 4; k++)
+  {
+    put(c, 0, 3, 300, 100);
+    put(c, 1, 4, 400, 100);
+    frame(&d, 2, c);
+  }
+  CHECK_EQ(frames, 4);
+  CHECK_EQ(last_contacts, 2);
+  CHECK_EQ(count_seen(2, EV_RELEASED), 1);
+  CHECK_EQ(last_seen(2)->x, 300);
+  lift(&d);
+  CHECK_EQ(last_contacts, 0);
+  CHECK_EQ(count_seen(2, EV_RELEASED), 1);
+  CHECK_EQ(count_seen(2), 2);
+}
+
+// Removing the recogniser while it has contacts cancels it. They go to nobody
+// until they lift, and then its slot can be used again.
+static void removed(int r)
+{
+  int k;
+
+  watch(&d);
+  reset();
+  for (k = 0; k < 3; k++)
+  {
+    put(c, 0, 5, 300, 100 + 5 * k);
+    put(c, 1, 6, 400, 100 + 5 * k);
+    frame(&d, 2, c);
+  }
+  CHECK_EQ(frames, 3);
+  d.removeRecognizer(r, now);
+  CHECK_EQ(cancels, 1);
+  for (k = 3; k < 10; k++)
+  {
+    put(c, 0, 5, 300, 100 + 5 * k);
+    put(c, 1, 6, 400, 100 + 5 * k);
+    frame(&d, 2, c);
+  }
+  CHECK_EQ(frames, 3);
+  CHECK_EQ(nseen, 0);
+  lift(&d);
+  CHECK_EQ(cancels, 1);
+  CHECK_EQ(d.addRecognizer(two_bid, two_frame, two_cancel), r);
+}
+
+int main()
+{
+  int r;
+
+  d.begin();
+  d.onDrag(0, 0, 240, 400, drag_cb, 1);
+  d.onTap(240, 0, 240, 400, tap_cb, 2);
+  r = d.addRecognizer(two_bid, two_frame, two_cancel);
+  CHECK_EQ(r, 0);
+
+  beside_drag();
+  after_tap();
+  removed(r);
+  TEST_DONE();
+}
@@ -0,0 +1,114 @@
+#include "test.h"
+
+// Transformed and shared regions: a region moved, scaled or rotated with
+// transformRegion is hit where the same polygon, with each of its vertices
+// transformed and registered again, would be, apart from a pixel's rounding at
+// its edges. Transforms replace each other rather than adding up, and events
+// sharing a region are hit wherever it is, whichever of them moved it.
+
+GestureDetector d;
+
+// An arrow pointing right, with sloping and upright edges.
+#define NARROW 7
+
+static Point arrow[NARROW] =
+{
+  Point(100, 180), Point(220, 180), Point(220, 130), Point(320, 220),
+  Point(220, 310), Point(220, 260), Point(100, 260)
+};
+
+// Points where the event at indx and the arrow put through xf disagree, other
+// than next to the moved arrow's edges.
+static int differences(int indx, Affine xf)
+{
+  Point moved[NARROW + 1];
+
+  move_polygon(arrow, NARROW, xf, moved);
+  return differences(&d, indx, moved, NARROW, 3, 1);
+}
+
+// Whether the region is hit at all, so the comparisons above aren't vacuous.
+static bool hit_at(int indx, Affine xf)
+{
+  Point p = xf.apply(200, 220);
+
+  return d.findEvent(EV_TAP, p.x, p.y) == indx;
+}
+
+// Moves, scales, a rotation and a shear, each against the transformed vertices.
+static void transforms(void)
+{
+  Affine xfs[] =
+  {
+    Affine(),
+    Affine(60, -40),
+    Affine(-50, 100, 1.5, 0.75),
+    Affine(300, 20, 0.866, -0.5, 0.5, 0.866),
+    Affine(20, 10, 1, 0.3, 0, 1),
+  };
+
+  for (unsigned k = 0; k < sizeof(xfs) / sizeof(xfs[0]); k++)
+  {
+    d.transformRegion(0, xfs[k]);
+    CHECK(hit_at(0, xfs[k]));
+    CHECK_EQ(differences(0, xfs[k]), 0);
+  }
+  d.transformRegion(0, 0, 0);
+}
+
+// A transform applies to the region as registered, so passing the same one
+// twice leaves it where the first put it, and one that can't be undone (a
+// scale of zero) leaves the region where it was.
+static void replaced(void)
+{
+  d.transformRegion(0, 40, 0);
+  d.transformRegion(0, 40, 0);
+  CHECK_EQ(differences(0, Affine(40, 0)), 0);
+  d.transformRegion(0, 0, 0, 0, 1);
+  CHECK_EQ(differences(0, Affine(40, 0)), 0);
+  d.transformRegion(0, 0, 0);
+}
+
+// A drag sharing the tap's region is hit wherever the tap is, as either is
+// moved; registering the drag again gives it a region of its own.
+static void shared(void)
+{
+  int x, y, bad = 0;
+
+  d.onDrag(0, 0, 40, 40, drag_cb, 1);
+  d.shareRegion(1, 0);
+  d.transformRegion(1, 30, 50, 0.5, 1);
+  CHECK_EQ(differences(0, Affine(30, 50, 0.5, 1)), 0);
+  d.transformRegion(0, -20, 10);
+  for (y = 0; y < HEIGHT; y += 5)
+  {
+    for (x = 0; x < WIDTH; x += 5)
+    {
+      if ((d.findEvent(EV_TAP, x, y) == 0) != (d.findEvent(EV_DRAG, x, y) == 1))
+        bad++;
+    }
+  }
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(d.findEvent(EV_DRAG, 100 - 20, 200 + 10), 1);
+
+  d.onDrag(0, 0, 40, 40, drag_cb, 1);
+  CHECK_EQ(d.findEvent(EV_DRAG, 100 - 20, 200 + 10), -1);
+  CHECK_EQ(d.findEvent(EV_DRAG, 20, 20), 1);
+  CHECK_EQ(d.findEvent(EV_TAP, 100 - 20, 200 + 10), 0);
+  d.cancelEvent(1);
+  d.transformRegion(0, 0, 0);
+}
+
+int main()
+{
+  d.begin();
+  d.onTap(arrow, NARROW, tap_cb, 0);
+
+  transforms();
+  replaced();
+  shared();
+  d.setHitMap(true);
+  transforms();
+  shared();
+  TEST_DONE();
+}
@@ -0,0 +1,94 @@
+#include "test.h"
+#include "Arduino_GigaDisplayTouch.h"
+
+// The scan rate: poll() reads the controller every IDLE_SCAN_TIME ms while
+// nothing is touching, every SCAN_TIME ms while something is or a drag is
+// carrying on by inertia, and nextPollDue() says when. setScanTimes() takes
+// effect at once.
+
+GestureDetector d;
+
+static void touch(int x, int y)
+{
+  GDTpoint_t p;
+
+  memset(&p, 0, sizeof(p));
+  p.x = x;
+  p.y = y;
+  p.area = 10;
+  host_touch(1, &p);
+}
+
+static void untouch(void)
+{
+  GDTpoint_t none[1];
+
+  host_touch(0, none);
+}
+
+// Nothing is read before a scan is due.
+static void idle(void)
+{
+  watch(&d);
+  d.poll(now);
+  CHECK_EQ(d.nextPollDue(), now + IDLE_SCAN_TIME);
+  touch(100, 100);
+  d.poll(now + IDLE_SCAN_TIME - 1);
+  CHECK_EQ(nseen, 0);
+  now += IDLE_SCAN_TIME;
+  d.poll(now);
+  CHECK_EQ(d.nextPollDue(), now + SCAN_TIME);
+}
+
+// A drag (held past SWIPE_TIME, so not a swipe) flung as it's released keeps
+// the scan rate up until it stops.
+static void fling(void)
+{
+  int k, scans;
+
+  for (k = 1; k <= SWIPE_TIME / SCAN_TIME + 5; k++)
+  {
+    touch(100 + 10 * k, 100);
+    now += SCAN_TIME;
+    d.poll(now);
+  }
+  CHECK(count_seen(0, EV_DRAG) > 0);
+  untouch();
+  now += SCAN_TIME;
+  d.poll(now);
+  CHECK_EQ(count_seen(0, EV_DRAG | EV_RELEASED), 0);
+  for (scans = 0; d.nextPollDue() == now + SCAN_TIME && scans < 100; scans++)
+  {
+    now += SCAN_TIME;
+    d.poll(now);
+  }
+  CHECK(scans > 1);
+  CHECK(scans < 100);
+  CHECK_EQ(count_seen(0, EV_DRAG | EV_RELEASED), 1);
+  CHECK_EQ(d.nextPollDue(), now + IDLE_SCAN_TIME);
+}
+
+// A faster rate brings the next scan forward; a slower one doesn't put it off.
+static void set_times(void)
+{
+  d.setScanTimes(SCAN_TIME, IDLE_SCAN_TIME / 2);
+  CHECK_EQ(d.nextPollDue(), now + IDLE_SCAN_TIME / 2);
+  d.setScanTimes(SCAN_TIME, IDLE_SCAN_TIME * 2);
+  CHECK_EQ(d.nextPollDue(), now + IDLE_SCAN_TIME / 2);
+  now += IDLE_SCAN_TIME / 2;
+  d.poll(now);
+  CHECK_EQ(d.nextPollDue(), now + IDLE_SCAN_TIME * 2);
+  d.setScanTimes(SCAN_TIME, IDLE_SCAN_TIME);
+}
+
+int main()
+{
+  d.begin();
+  d.onDrag(0, 0, 480, 800, drag_cb, 0, NULL, CO_NONE, 3, true);
+  untouch();
+
+  idle();
+  fling();
+  set_times();
+  TEST_DONE();
+}
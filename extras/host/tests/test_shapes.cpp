@@ -0,0 +1,162 @@
+#include "test.h"
+
+// Region shapes: a rectangle tested as one gives exactly the answers of the
+// same rectangle tested as a polygon, plain or transformed. An ellipse or a
+// rounded rectangle made with setRegionShape is hit where a fine polygon
+// following its outline would be, apart from a pixel or two at the edge, with
+// or without the hit map; and RS_POLYGON puts back the region's own polygon.
+
+GestureDetector d;
+
+// The fine polygon: 64 points on each quarter of an ellipse, or on each corner
+// of a rounded rectangle, and the first again at the end.
+#define NFINE (4 * 64)
+
+static Point fine[NFINE + 1];
+
+// The outline of the ellipse filling (x0, y0) to (x1, y1), or of the rectangle
+// with corners rounded to r, put through xf.
+static void outline(int x0, int y0, int x1, int y1, int r, bool ellipse, Affine xf)
+{
+  float p[2 * NFINE];
+  float cx[4] = { (float)x1 - r, (float)x0 + r, (float)x0 + r, (float)x1 - r };
+  float cy[4] = { (float)y1 - r, (float)y1 - r, (float)y0 + r, (float)y0 + r };
+
+  for (int k = 0; k < NFINE; k++)
+  {
+    float a = k * 2 * PI / NFINE;
+
+    if (ellipse)
+    {
+      p[2 * k] = (x0 + x1) / 2.0 + (x1 - x0) / 2.0 * cos(a);
+      p[2 * k + 1] = (y0 + y1) / 2.0 + (y1 - y0) / 2.0 * sin(a);
+    }
+    else
+    {
+      p[2 * k] = cx[k / 64] + r * cos(a);
+      p[2 * k + 1] = cy[k / 64] + r * sin(a);
+    }
+  }
+  xf.apply(p, p, NFINE);
+  for (int k = 0; k < NFINE; k++)
+    fine[k] = Point(floorf(p[2 * k] + 0.5f), floorf(p[2 * k + 1] + 0.5f));
+  fine[NFINE] = fine[0];
+}
+
+// Points where the tap at indx and the fine polygon disagree, more than two
+// pixels from its edge.
+static int differences(int indx, int *hits)
+{
+  return differences(&d, indx, fine, NFINE, 2, 2, hits);
+}
+
+// The tap at 0, registered as x, y, w, h, is tested as a rectangle; the drag at
+// 1, the same rectangle listed the other way round, as a polygon. They agree at
+// every point around it, as registered and transformed.
+static void rectangles(void)
+{
+  Point rc[4] = { Point(100, 100), Point(100, 180), Point(260, 180), Point(260, 100) };
+  Affine xfs[] =
+  {
+    Affine(),
+    Affine(50, -30, 1.5, 0.5),
+    Affine(300, -50, 0.8, -0.6, 0.6, 0.8),
+  };
+  int x, y, bad = 0, hits = 0;
+
+  d.onTap(100, 100, 160, 80, tap_cb, 0);
+  d.onDrag(rc, 4, drag_cb, 1);
+  for (unsigned k = 0; k < sizeof(xfs) / sizeof(xfs[0]); k++)
+  {
+    d.transformRegion(0, xfs[k]);
+    d.transformRegion(1, xfs[k]);
+    for (y = 0; y < HEIGHT; y++)
+    {
+      for (x = 0; x < WIDTH; x++)
+      {
+        if ((d.findEvent(EV_TAP, x, y) == 0) != (d.findEvent(EV_DRAG, x, y) == 1))
+          bad++;
+        if (d.findEvent(EV_TAP, x, y) == 0)
+          hits++;
+      }
+    }
+  }
+  CHECK_EQ(bad, 0);
+  CHECK(hits > 3 * 160 * 80 / 2);
+  CHECK_EQ(d.findEvent(EV_TAP, 100, 100), -1);
+  d.cancelEvent(0);
+  d.cancelEvent(1);
+}
+
+// An ellipse, a circle and rounded rectangles, plain and transformed.
+static void curves(void)
+{
+  Affine turned(200, -40, 0.866, -0.5, 0.5, 0.866);
+  int hits;
+
+  d.onTap(60, 100, 300, 160, tap_cb, 0);
+  d.setRegionShape(0, RS_ELLIPSE);
+  outline(60, 100, 360, 260, 0, true, Affine());
+  CHECK_EQ(differences(0, &hits), 0);
+  CHECK(hits > 8000);
+  d.transformRegion(0, turned);
+  outline(60, 100, 360, 260, 0, true, turned);
+  CHECK_EQ(differences(0, &hits), 0);
+  CHECK(hits > 8000);
+
+  d.onTap(100, 400, 200, 200, tap_cb, 0);
+  d.setRegionShape(0, RS_ELLIPSE);
+  outline(100, 400, 300, 600, 0, true, Affine());
+  CHECK_EQ(differences(0, &hits), 0);
+
+  d.setRegionShape(0, RS_ROUND_RECT, 40);
+  outline(100, 400, 300, 600, 40, false, Affine());
+  CHECK_EQ(differences(0, &hits), 0);
+  CHECK(hits > 9000);
+  d.transformRegion(0, turned);
+  outline(100, 400, 300, 600, 40, false, turned);
+  CHECK_EQ(differences(0, &hits), 0);
+
+  // A radius more than half the rectangle is cut down to half: a circle.
+  d.transformRegion(0, 0, 0);
+  d.setRegionShape(0, RS_ROUND_RECT, 500);
+  outline(100, 400, 300, 600, 100, false, Affine());
+  CHECK_EQ(differences(0, &hits), 0);
+}
+
+// RS_POLYGON puts back a triangle that was made an ellipse.
+static void restored(void)
+{
+  Point tri[3] = { Point(100, 100), Point(300, 120), Point(150, 300) };
+  int x, y, bad = 0;
+
+  d.onTap(tri, 3, tap_cb, 0);
+  d.setRegionShape(0, RS_ELLIPSE);
+  CHECK_EQ(d.findEvent(EV_TAP, 280, 200), 0);
+  d.setRegionShape(0, RS_POLYGON);
+  CHECK_EQ(d.findEvent(EV_TAP, 280, 200), -1);
+  for (y = 90; y < 310; y++)
+  {
+    for (x = 90; x < 310; x++)
+    {
+      Point closed[4] = { tri[0], tri[1], tri[2], tri[0] };
+
+      if ((d.findEvent(EV_TAP, x, y) == 0) != (Point(x, y).in_polygon(closed, 3) != 0))
+        bad++;
+    }
+  }
+  CHECK_EQ(bad, 0);
+  d.cancelEvent(0);
+}
+
+int main()
+{
+  d.begin();
+
+  rectangles();
+  curves();
+  restored();
+  d.setHitMap(true);
+  curves();
+  TEST_DONE();
+}
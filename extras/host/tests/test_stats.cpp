@@ -0,0 +1,130 @@
+#include "test.h"
+#include "Arduino_GigaDisplayTouch.h"
+
+// Instrumentation: a tap read through poll() is counted as it goes, with a
+// poll, a controller read and a frame for each scan that was due, and a
+// callback (timed and counted by type) for each made. In queued mode the
+// callback times are kept by dispatch(), apart from the rest. Built with
+// GD_INSTRUMENT 0, as by "make test", the stats are all zeros; "make configs"
+// builds this with it set to 1.
+
+GestureDetector d;
+
+static void touch(int x, int y)
+{
+  GDTpoint_t p;
+
+  memset(&p, 0, sizeof(p));
+  p.x = x;
+  p.y = y;
+  p.area = 10;
+  host_touch(1, &p);
+}
+
+static void untouch(void)
+{
+  GDTpoint_t none[1];
+
+  host_touch(0, none);
+}
+
+// Touch for a few scans, then let go and scan until the tap is over; each scan
+// is also polled again before it is due, which doesn't count. Returns the
+// number of scans.
+static int tap(void)
+{
+  int k, scans = 0;
+
+  touch(100, 100);
+  for (k = 0; k < 3; k++)
+  {
+    now += IDLE_SCAN_TIME;
+    d.poll(now);
+    d.poll(now + 1);
+    scans++;
+  }
+  untouch();
+  for (k = 0; k < 20; k++)
+  {
+    now += IDLE_SCAN_TIME;
+    d.poll(now);
+    d.poll(now + 1);
+    scans++;
+  }
+  return scans;
+}
+
+static void counted(void)
+{
+  GestureStats s;
+  int scans;
+
+  d.resetStats();
+  watch(&d);
+  scans = tap();
+  d.getStats(&s);
+  CHECK_EQ(scans, 3 + 20);
+  CHECK(count_seen(0, EV_TAP) > 0);
+  CHECK_EQ(nseen, count_seen(0, EV_TAP));
+#if GD_INSTRUMENT
+  CHECK_EQ(s.polls, scans);
+  CHECK_EQ(s.frames, scans);
+  CHECK_EQ(s.phase[PH_POLL].count, scans);
+  CHECK_EQ(s.phase[PH_READ].count, scans);
+  CHECK_EQ(s.phase[PH_FRAME].count, scans);
+  CHECK_EQ(s.callbacks[EV_TAP], nseen);
+  CHECK_EQ(s.callbacks[EV_DRAG], 0);
+  CHECK_EQ(s.phase[PH_CALLBACK].count, nseen);
+  CHECK(s.hit_tests > 0);
+  d.dumpStats(&Serial);
+#else
+  CHECK_EQ(s.polls, 0);
+  CHECK_EQ(s.frames, 0);
+  CHECK_EQ(s.phase[PH_POLL].count, 0);
+  CHECK_EQ(s.callbacks[EV_TAP], 0);
+#endif
+
+  d.resetStats();
+  d.getStats(&s);
+  CHECK_EQ(s.polls, 0);
+  CHECK_EQ(s.phase[PH_CALLBACK].count, 0);
+}
+
+// Queued, the callbacks are counted as they are queued, but timed only as
+// dispatch() makes them, and getStats leaves their times out.
+static void queued(void)
+{
+  GestureStats s;
+  PhaseStats cb;
+  int made;
+
+  d.setQueued(true);
+  d.resetStats();
+  d.resetCallbackStats();
+  watch(&d);
+  tap();
+  d.getCallbackStats(&cb);
+  CHECK_EQ(cb.count, 0);
+  made = d.dispatch();
+  CHECK_EQ(made, nseen);
+  d.getStats(&s);
+  d.getCallbackStats(&cb);
+  CHECK_EQ(s.phase[PH_CALLBACK].count, 0);
+#if GD_INSTRUMENT
+  CHECK_EQ(s.callbacks[EV_TAP], nseen);
+  CHECK_EQ(cb.count, made);
+#else
+  CHECK_EQ(cb.count, 0);
+#endif
+  d.setQueued(false);
+}
+
+int main()
+{
+  d.begin();
+  d.onTap(0, 0, 480, 800, tap_cb, 0);
+
+  counted();
+  queued();
+  TEST_DONE();
+}
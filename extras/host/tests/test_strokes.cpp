@@ -0,0 +1,209 @@
+#include "test.h"
+
+// Strokes: a shape drawn at any position and size, through any number of
+// points, and turned by less than STROKE_ANGLE, matches its own template best,
+// with a score near 1. The integer matching gives the scores Protractor would:
+// the best cosine between the stroke and each template turned by up to
+// STROKE_ANGLE. Strokes are matched in the direction they are drawn, and one
+// drawn on the screen is called back with its match when it lifts.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+static void stroke_cb(EventType type, int indx, void *param, int match, float score) {}
+
+// Shapes in a 100 x 100 box.
+#define NSHAPES 5
+#define MAX_SHAPE 17
+
+static const Point shapes[NSHAPES][MAX_SHAPE] =
+{
+  { Point(0, 50), Point(30, 90), Point(100, 0) },                       // tick
+  { Point(0, 0), Point(33, 100), Point(66, 0), Point(100, 100) },       // zigzag
+  { Point(0, 0), Point(0, 100), Point(100, 100) },                      // L
+  { Point(0, 50), Point(100, 50) },                                     // line
+  { },                                                                  // circle
+};
+static int shape_pts[NSHAPES] = { 3, 4, 3, 2, 17 };
+static Point circle[MAX_SHAPE];
+
+static StrokeVector templates[NSHAPES];
+
+static void make_templates(void)
+{
+  for (int k = 0; k < MAX_SHAPE; k++)
+    circle[k] = Point(50 + 50 * cos(k * 2 * PI / 16), 50 + 50 * sin(k * 2 * PI / 16));
+  for (int s = 0; s < NSHAPES; s++)
+    CHECK(stroke_template(&templates[s], s == 4 ? circle : shapes[s], shape_pts[s]));
+}
+
+static const Point *shape(int s)
+{
+  return s == 4 ? circle : shapes[s];
+}
+
+// Draw a shape as a stroke, put through xf, with a point every step pixels
+// along it (as a finger would give), optionally backwards.
+static bool draw(StrokeVector *v, int s, Affine xf, int step, bool backwards = false)
+{
+  StrokePath path;
+  Point p[MAX_SHAPE];
+  int n = shape_pts[s];
+
+  xf.apply(shape(s), p, n);
+  if (backwards)
+  {
+    for (int k = 0; k < n / 2; k++)
+    {
+      Point t = p[k];
+      p[k] = p[n - 1 - k];
+      p[n - 1 - k] = t;
+    }
+  }
+  stroke_begin(&path, p[0].x, p[0].y);
+  for (int k = 1; k < n; k++)
+  {
+    float len = sqrt((float)(p[k].x - p[k - 1].x) * (p[k].x - p[k - 1].x) + (float)(p[k].y - p[k - 1].y) * (p[k].y - p[k - 1].y));
+    int parts = max(1, (int)(len / step));
+
+    for (int j = 1; j <= parts; j++)
+      stroke_add(&path, p[k - 1].x + (p[k].x - p[k - 1].x) * j / parts, p[k - 1].y + (p[k].y - p[k - 1].y) * j / parts);
+  }
+  return stroke_finish(v, &path);
+}
+
+// Protractor's score for a stroke against a template, the slow way: turn the
+// template through the allowed angles a tenth of a degree at a time, and take
+// the best cosine between them.
+static float protractor(const StrokeVector *v, const StrokeVector *t)
+{
+  float best = -2;
+
+  for (int step = -10 * STROKE_ANGLE; step <= 10 * STROKE_ANGLE; step++)
+  {
+    float a = step * PI / 1800, ca = cos(a), sa = sin(a);
+    float sum = 0;
+
+    for (int j = 0; j < 2 * STROKE_POINTS; j += 2)
+    {
+      float tx = t->v[j] * ca - t->v[j + 1] * sa;
+      float ty = t->v[j] * sa + t->v[j + 1] * ca;
+
+      sum += tx * v->v[j] + ty * v->v[j + 1];
+    }
+    best = max(best, sum / (16384.0f * 16384.0f));
+  }
+  return best;
+}
+
+// Each shape, moved, scaled, turned a little and drawn through points at
+// different spacings, matches its own template.
+static void own_shapes(void)
+{
+  Affine xfs[] =
+  {
+    Affine(),
+    Affine(200, 300, 2, 2),
+    Affine(40, 500, 0.6, 0.6),
+    Affine(250, 250, 1.5 * 0.966, -1.5 * 0.259, 1.5 * 0.259, 1.5 * 0.966),   // turned 15 degrees
+  };
+  StrokeVector v;
+  float score;
+  int wrong = 0, poor = 0;
+
+  for (int s = 0; s < NSHAPES; s++)
+  {
+    for (unsigned x = 0; x < sizeof(xfs) / sizeof(xfs[0]); x++)
+    {
+      for (int step = 2; step <= 12; step += 5)
+      {
+        CHECK(draw(&v, s, xfs[x], step));
+        if (stroke_match(&v, templates, NSHAPES, &score) != s)
+          wrong++;
+        if (score < 0.95)
+          poor++;
+      }
+    }
+  }
+  CHECK_EQ(wrong, 0);
+  CHECK_EQ(poor, 0);
+
+  // A template matches itself exactly.
+  CHECK_EQ(stroke_match(&templates[1], templates, NSHAPES, &score), 1);
+  CHECK(fabs(score - 1) < 0.001);
+}
+
+// The scores, for every shape against every template, are Protractor's.
+static void scores(void)
+{
+  StrokeVector v;
+  float score, want;
+  int bad = 0;
+
+  for (int s = 0; s < NSHAPES; s++)
+  {
+    CHECK(draw(&v, s, Affine(100, 100, 1.2, 0.7, -0.3, 1), 4));
+    for (int t = 0; t < NSHAPES; t++)
+    {
+      stroke_match(&v, &templates[t], 1, &score);
+      want = protractor(&v, &templates[t]);
+      if (fabs(score - want) > 0.001)
+        bad++;
+    }
+  }
+  CHECK_EQ(bad, 0);
+}
+
+// A line drawn the other way, or turned a right angle, is a poor match; turned
+// past the limit, it is only turned back as far as the limit.
+static void direction(void)
+{
+  StrokeVector v;
+  float score;
+
+  CHECK(draw(&v, 3, Affine(), 4, true));
+  stroke_match(&v, &templates[3], 1, &score);
+  CHECK(score < -0.8);
+
+  CHECK(draw(&v, 3, Affine(150, 0, 0, -1, 1, 0), 4));
+  stroke_match(&v, &templates[3], 1, &score);
+  CHECK(fabs(score - cos((90 - STROKE_ANGLE) * PI / 180)) < 0.01);
+
+  // No templates, or no length, and there's no match.
+  CHECK_EQ(stroke_match(&v, templates, 0, &score), -1);
+  CHECK_EQ(score, 0);
+  CHECK(!stroke_template(&v, shapes[0], 1));
+}
+
+// A circle drawn on the screen, a contact moving 10 pixels a frame, is called
+// back once, as it lifts, with the circle's template.
+static void drawn(void)
+{
+  int k, steps = 48;
+
+  watch(&d);
+  for (k = 0; k <= steps; k++)
+  {
+    put(c, 0, 0, 240 + 80 * cos(k * 2 * PI / steps), 400 + 80 * sin(k * 2 * PI / steps));
+    frame(&d, 1, c);
+  }
+  CHECK_EQ(nseen, 0);
+  lift(&d);
+  CHECK_EQ(nseen, 1);
+  CHECK_EQ(seen[0].type, EV_STROKE | EV_RELEASED);
+  CHECK_EQ(seen[0].dx, 4);
+  CHECK(seen[0].sx > 0.95);
+}
+
+int main()
+{
+  make_templates();
+  d.begin();
+  d.onStroke(0, 0, 480, 800, stroke_cb, 0, templates, NSHAPES);
+
+  own_shapes();
+  scores();
+  direction();
+  drawn();
+  TEST_DONE();
+}
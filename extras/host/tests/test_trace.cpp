@@ -0,0 +1,140 @@
+#include "test.h"
+#include "GestureTrace.h"
+#include "Arduino_GigaDisplayTouch.h"
+
+// Touch traces: a trace recorded from poll() replays to the same callbacks,
+// including contact areas too big for a byte (as a palm's can be), and long
+// gaps. A trace from a screen of another size is refused.
+
+GestureDetector d;
+uint8_t buf[4096];
+
+static GDTpoint_t point(int id, int x, int y, int area)
+{
+  GDTpoint_t p;
+
+  memset(&p, 0, sizeof(p));
+  p.trackId = id;
+  p.x = x;
+  p.y = y;
+  p.area = area;
+  return p;
+}
+
+static bool same(const GestureRecord *a, const GestureRecord *b)
+{
+  return a->type == b->type && a->indx == b->indx
+    && a->x == b->x && a->y == b->y && a->dx == b->dx && a->dy == b->dy
+    && a->sx == b->sx && a->sy == b->sy;
+}
+
+// Record a drag with a palm resting on the screen beside it, then replay it.
+static void record_replay(void)
+{
+  TraceWriter writer(buf, sizeof(buf));
+  GDTpoint_t p[2];
+  GestureRecord recorded[MAX_SEEN];
+  int nrecorded;
+  int k;
+
+  d.begin();
+  d.setPalmArea(280);
+  d.onDrag(0, 0, 480, 800, drag_cb, 1);
+  watch(&d);
+  writer.begin();
+  d.setRecorder(&writer);
+  for (k = 0; k < 12; k++)
+  {
+    p[0] = point(0, 100 + 10 * k, 100, 10);
+    p[1] = point(1, 400, 700, 300);
+    host_touch(2, p);
+    now += FRAME_TIME;
+    d.poll(now);
+  }
+
+  host_touch(0, p);
+  for (k = 0; k < 20; k++)
+  {
+    now += FRAME_TIME;
+    d.poll(now);
+  }
+
+  // A long gap, then another drag.
+  now += 100000;
+  for (k = 0; k < 8; k++)
+  {
+    p[0] = point(2, 200, 200 + 10 * k, 10);
+    host_touch(1, p);
+    now += FRAME_TIME;
+    d.poll(now);
+  }
+  host_touch(0, p);
+  for (k = 0; k < 20; k++)
+  {
+    now += FRAME_TIME;
+    d.poll(now);
+  }
+  d.setRecorder(NULL);
+  CHECK(!writer.overflowed());
+  CHECK_EQ(count_seen(1, EV_RELEASED), 2);
+  memcpy(recorded, seen, sizeof(seen));
+  nrecorded = nseen;
+
+  // Every frame polled was recorded, with the palm's area as it was.
+  TraceReader reader(buf, writer.length());
+  unsigned long time;
+  uint8_t contacts;
+  TouchContact c[MAX_CONTACTS];
+  CHECK(reader.begin());
+  CHECK(reader.next(&time, &contacts, c));
+  CHECK_EQ(contacts, 2);
+  CHECK_EQ(c[1].area, 300);
+
+  GestureDetector r;
+  r.begin();
+  r.setPalmArea(280);
+  r.onDrag(0, 0, 480, 800, drag_cb, 1);
+  watch(&r);
+  CHECK(replayTrace(&r, &reader) > 20);
+  CHECK_EQ(nseen, nrecorded);
+  for (k = 0; k < nseen && k < nrecorded; k++)
+    CHECK(same(&seen[k], &recorded[k]));
+}
+
+// A trace from a screen of another size, or of another version, isn't replayed.
+static void mismatch(void)
+{
+  uint8_t trace[TRACE_HEADER_SIZE + 3];
+  TraceWriter writer(trace, sizeof(trace));
+  TouchContact c[1];
+
+  writer.begin();
+  writer.frame(1000, 0, c);
+  CHECK_EQ(writer.length(), sizeof(trace));
+
+  TraceReader good(trace, sizeof(trace));
+  CHECK_EQ(replayTrace(&d, &good), 1);
+
+  trace[6] = (HEIGHT & 0xFF);
+  trace[7] = HEIGHT >> 8;
+  trace[8] = (WIDTH & 0xFF);
+  trace[9] = WIDTH >> 8;
+  TraceReader rotated(trace, sizeof(trace));
+  CHECK(!rotated.begin());
+  CHECK_EQ(replayTrace(&d, &rotated), -1);
+
+  trace[6] = (WIDTH & 0xFF);
+  trace[7] = WIDTH >> 8;
+  trace[8] = (HEIGHT & 0xFF);
+  trace[9] = HEIGHT >> 8;
+  trace[4] = TRACE_VERSION + 1;
+  TraceReader later(trace, sizeof(trace));
+  CHECK_EQ(replayTrace(&d, &later), -1);
+}
+
+int main()
+{
+  record_replay();
+  mismatch();
+  TEST_DONE();
+}
@@ -0,0 +1,164 @@
+#include "test.h"
+
+// Tracking several contacts at once: drags in different regions go on
+// independently, two contacts only pinch when both are in a pinch region,
+// and a contact the controller renumbers is still followed.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+// Two drags at once, in different regions, lifted at different times.
+static void concurrent_drags(void)
+{
+  int k;
+
+  watch(&d);
+  for (k = 0; k < 12; k++)
+  {
+    // List them in a different order each frame; only the trackIds matter.
+    put(c, k & 1, 0, 50 + 5 * k, 100);
+    put(c, 1 - (k & 1), 1, 300, 100 + 5 * k);
+    frame(&d, 2, c);
+  }
+  for (k = 12; k < 16; k++)
+  {
+    put(c, 0, 1, 300, 100 + 5 * k);
+    frame(&d, 1, c);
+  }
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  CHECK_EQ(count_seen(2, EV_RELEASED), 0);
+  CHECK(count_seen(1) > 2);
+  CHECK_EQ(last_seen(1)->dx, 55);
+  CHECK_EQ(last_seen(1)->dy, 0);
+  CHECK_EQ(last_seen(2)->dx, 0);
+  CHECK_EQ(last_seen(2)->dy, 75);
+  lift(&d);
+  CHECK_EQ(count_seen(2, EV_RELEASED), 1);
+  CHECK_EQ(last_seen(2)->dy, 75);
+  CHECK_EQ(count_seen(3), 0);
+}
+
+// Two contacts in the pinch region make a pinch, whether they land together
+// or one after the other.
+static void pinch_pairs(void)
+{
+  int k;
+
+  watch(&d);
+  for (k = 0; k < 6; k++)
+  {
+    put(c, 0, 0, 200 - 10 * k, 600);
+    put(c, 1, 1, 280 + 10 * k, 600);
+    frame(&d, 2, c);
+  }
+  lift(&d);
+  CHECK(count_seen(3, EV_PINCH) > 2);
+  CHECK_EQ(count_seen(3, EV_RELEASED), 1);
+  CHECK_EQ(last_seen(3)->dx, -300);
+  CHECK(fabs(last_seen(3)->sx - 180.0 / 80) < 0.01);
+
+  watch(&d);
+  put(c, 0, 4, 200, 600);
+  frame(&d, 1, c);
+  frame(&d, 1, c);
+  for (k = 0; k < 6; k++)
+  {
+    put(c, 0, 4, 200 - 10 * k, 600);
+    put(c, 1, 5, 280 + 10 * k, 600);
+    frame(&d, 2, c);
+  }
+  lift(&d);
+  CHECK(count_seen(3, EV_PINCH) > 2);
+  CHECK_EQ(count_seen(3, EV_RELEASED), 1);
+}
+
+// A pinch that loses a finger is moved along by the other, and carries on from
+// there when a finger lands again.
+static void pinch_resumed(void)
+{
+  int k;
+
+  watch(&d);
+  for (k = 0; k < 4; k++)
+  {
+    put(c, 0, 0, 200 + 2 * k, 600);
+    put(c, 1, 1, 280 + 2 * k, 600);
+    frame(&d, 2, c);
+  }
+  CHECK_EQ(last_seen(3)->dx, 6);
+  put(c, 0, 0, 206, 600);
+  frame(&d, 1, c);
+  for (k = 1; k <= 10; k++)
+  {
+    put(c, 0, 0, 206 + 4 * k, 600 + 5 * k);
+    frame(&d, 1, c);
+  }
+  CHECK_EQ(last_seen(3)->dx, 46);
+  CHECK_EQ(last_seen(3)->dy, 50);
+  put(c, 0, 0, 246, 650);
+  put(c, 1, 3, 326, 650);
+  frame(&d, 2, c);
+  put(c, 0, 0, 247, 650);
+  put(c, 1, 3, 327, 650);
+  frame(&d, 2, c);
+  CHECK_EQ(last_seen(3)->dx, 47);
+  CHECK_EQ(last_seen(3)->dy, 50);
+  CHECK(fabs(last_seen(3)->sx - 1) < 0.01);
+  lift(&d);
+  CHECK_EQ(count_seen(3, EV_RELEASED), 1);
+}
+
+// A contact in a drag region and one in the pinch region don't pinch: the
+// drag goes on, and the other contact has no event to take.
+static void pinch_needs_both(void)
+{
+  int k;
+
+  watch(&d);
+  for (k = 0; k < 12; k++)
+  {
+    put(c, 0, 0, 50 + 5 * k, 300);
+    put(c, 1, 1, 200 + 5 * k, 500);
+    frame(&d, 2, c);
+  }
+  lift(&d);
+  CHECK_EQ(count_seen(3), 0);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  CHECK_EQ(last_seen(1)->dx, 55);
+}
+
+// A contact whose trackId changes, without moving far, carries on its drag.
+// One that jumps further than MATCH_DISTANCE is a new contact.
+static void renumbered(void)
+{
+  int k;
+
+  watch(&d);
+  for (k = 0; k < 12; k++)
+  {
+    put(c, 0, k < 8 ? 2 : 7, 50 + 5 * k, 100);
+    frame(&d, 1, c);
+  }
+  CHECK_EQ(count_seen(1, EV_RELEASED), 0);
+  CHECK_EQ(last_seen(1)->dx, 55);
+
+  put(c, 0, 9, 50 + 55 + MATCH_DISTANCE + 10, 100);
+  frame(&d, 1, c);
+  CHECK_EQ(count_seen(1, EV_RELEASED), 1);
+  lift(&d);
+}
+
+int main()
+{
+  d.begin();
+  d.onDrag(0, 0, 240, 400, drag_cb, 1);
+  d.onDrag(240, 0, 240, 400, drag_cb, 2);
+  d.onPinch(0, 400, 480, 400, pinch_cb, 3);
+
+  concurrent_drags();
+  pinch_pairs();
+  pinch_resumed();
+  pinch_needs_both();
+  renumbered();
+  TEST_DONE();
+}
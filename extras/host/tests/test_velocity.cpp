@@ -0,0 +1,106 @@
+#include "test.h"
+
+// Velocity estimates: the least squares fit to a contact's recent positions
+// gives its velocity and acceleration exactly for steady or steadily speeding
+// up motion, however unevenly the frames are spaced, and the callbacks (and
+// getVelocity, getAcceleration) report them. A swipe is known by its speed.
+
+GestureDetector d;
+TouchContact c[MAX_CONTACTS];
+
+// The motion as seen from inside the last drag callback.
+static float cb_vx, cb_vy, cb_ax, cb_ay;
+
+static void motion_cb(EventType type, int indx, void *param, int x, int y, int dx, int dy)
+{
+  d.getVelocity(&cb_vx, &cb_vy);
+  d.getAcceleration(&cb_ax, &cb_ay);
+}
+
+static bool near(float a, float b, float tol)
+{
+  return fabs(a - b) <= tol;
+}
+
+static void at(unsigned long t, int x, int y)
+{
+  put(c, 0, 0, x, y);
+  now = t;
+  d.processFrame(now, 1, c);
+}
+
+// 0.2 pixels/ms to the right and 0.1 up, with frames 25 and 35 ms apart.
+static void steady(void)
+{
+  unsigned long t0 = now + FRAME_TIME;
+  unsigned long t = 0;
+  int k;
+
+  watch(&d);
+  for (k = 0; k < 12; k++)
+  {
+    at(t0 + t, 100 + t / 5, 400 - t / 10);
+    t += (k & 1) ? 35 : 25;
+  }
+  CHECK(count_seen(1, EV_DRAG) > 0);
+  CHECK(near(last_seen(1)->vx, 0.2, 0.001));
+  CHECK(near(last_seen(1)->vy, -0.1, 0.001));
+  CHECK(near(last_seen(1)->ax, 0, 0.0001));
+  CHECK(near(last_seen(1)->ay, 0, 0.0001));
+  CHECK(near(cb_vx, 0.2, 0.001));
+  CHECK(near(cb_ax, 0, 0.0001));
+  lift(&d);
+}
+
+// x = 3 (t / 30)^2: v = t / 150 and a = 1 / 150 at time t.
+static void speeding_up(void)
+{
+  unsigned long t0 = now + FRAME_TIME;
+  int k;
+
+  watch(&d);
+  for (k = 0; k < 12; k++)
+    at(t0 + 30 * k, 100 + 3 * k * k, 400);
+  CHECK(near(last_seen(1)->vx, 30 * 11 / 150.0, 0.001));
+  CHECK(near(last_seen(1)->ax, 1 / 150.0, 0.0001));
+  CHECK(near(last_seen(1)->vy, 0, 0.001));
+  CHECK(near(cb_ax, 1 / 150.0, 0.0001));
+  lift(&d);
+}
+
+// A quick flick is a swipe; the same distance covered slowly is not.
+static void swipes(void)
+{
+  int k;
+
+  watch(&d);
+  for (k = 0; k < 4; k++)
+  {
+    put(c, 0, 0, 100 + 15 * k, 700);
+    frame(&d, 1, c);
+  }
+  lift(&d);
+  CHECK_EQ(count_seen(2, EV_SWIPE | EV_RELEASED), 1);
+  CHECK(near(last_seen(2)->vx, 0.5, 0.001));
+
+  watch(&d);
+  for (k = 0; k < 4; k++)
+  {
+    put(c, 0, 0, 100 + 3 * k, 700);
+    frame(&d, 1, c);
+  }
+  lift(&d);
+  CHECK_EQ(count_seen(2), 0);
+}
+
+int main()
+{
+  d.begin();
+  d.onDrag(0, 0, 480, 600, motion_cb, 1);
+  d.onSwipe(0, 600, 480, 200, drag_cb, 2);
+
+  steady();
+  speeding_up();
+  swipes();
+  TEST_DONE();
+}
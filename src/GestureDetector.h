@@ -5,27 +5,222 @@
 
 // Gesture detection.
 
+// The settings below can be changed for a build on the compiler command line
+// (e.g. -DMAX_EVENTS=8), so variants for different panels and screens can be
+// built from the same source. They must be the same everywhere the header is
+// included, the library's own files too, or the files won't agree on the layout
+// of GestureDetector (breaking the one-definition rule, unnoticed by the build).
+
 // Width and height of screen in its natural rotation.
+#ifndef WIDTH
 #define WIDTH             480
+#endif
+#ifndef HEIGHT
 #define HEIGHT            800
+#endif
+
+// The gestures to be recognised. Setting any of these to 0 compiles out
+// its onXxx calls, the code to recognise it and the state kept for it: a
+// fling's for drags; the velocity history and the affine callbacks for drags,
+// swipes and pinches together; a pinch's solver state for pinches.
+#ifndef GD_USE_TAP
+#define GD_USE_TAP        1
+#endif
+#ifndef GD_USE_DRAG
+#define GD_USE_DRAG       1
+#endif
+#ifndef GD_USE_SWIPE
+#define GD_USE_SWIPE      1
+#endif
+#ifndef GD_USE_PINCH
+#define GD_USE_PINCH      1
+#endif
+#ifndef GD_USE_STROKE
+#define GD_USE_STROKE     1
+#endif
+
+// Define GD_ROTATION (0-3) to fix the screen rotation at compile time, rather
+// than setting it with setRotation().
+
+// The time between scans of the touch screen, in ms, while it is being touched
+// (or a drag is carrying on by inertia), and while it is idle. A fast scan
+// keeps drags smooth; the slow one only has to catch the first touch. These can
+// also be changed with setScanTimes().
+#ifndef SCAN_TIME
+#define SCAN_TIME         10
+#endif
+#ifndef IDLE_SCAN_TIME
+#define IDLE_SCAN_TIME    100
+#endif
+
+// The number of timestamped samples held between interrupts and poll()
+// in capture mode. Must be a power of 2.
+#ifndef CAPTURE_SIZE
+#define CAPTURE_SIZE      16
+#endif
+
+#if (CAPTURE_SIZE & (CAPTURE_SIZE - 1)) != 0
+#error "CAPTURE_SIZE must be a power of 2"
+#endif
+
+// The number of callbacks held between poll() and dispatch() in queued mode,
+// and how many of them are kept back for releases. Must be a power of 2.
+#ifndef QUEUE_SIZE
+#define QUEUE_SIZE        32
+#endif
+#ifndef QUEUE_RESERVE
+#define QUEUE_RESERVE     8
+#endif
 
-// The time between scans of the touch screen, in ms.
-#define SCAN_TIME         30
+#if (QUEUE_SIZE & (QUEUE_SIZE - 1)) != 0
+#error "QUEUE_SIZE must be a power of 2"
+#endif
+
+// In capture mode, the time (in ms) after the last sample from the controller
+// when all contacts are taken to have been released.
+#ifndef RELEASE_TIME
+#define RELEASE_TIME      60
+#endif
 
 // The long press duration (in ms)
+#ifndef LONG_PRESS_TIME
 #define LONG_PRESS_TIME   500
+#endif
+
+// Multi-taps. A tap counts as the next of a double (triple...) tap if it lands
+// within MULTI_TAP_TIME ms of the last tap in the same region lifting, and
+// within MULTI_TAP_DISTANCE pixels of where that one landed.
+#ifndef MULTI_TAP_TIME
+#define MULTI_TAP_TIME    300
+#endif
+#ifndef MULTI_TAP_DISTANCE
+#define MULTI_TAP_DISTANCE 30
+#endif
 
 // The swipe speed, defined as a pixels/ms value (total dx or dy / time in ms)
 // as measured after at least SWIPE_TIME has elapsed.
-// The swipe time is about 5 scans worth at 30ms / scan.
+#ifndef SWIPE_TIME
 #define SWIPE_TIME        150
+#endif
+
+// The default minimum speed (in pixels/ms) at release for a swipe. It can be
+// set for each swipe region when it is registered.
+#ifndef SWIPE_SPEED
+#define SWIPE_SPEED       0.3
+#endif
+
+// Inertia for drags registered with it. After release, the drag carries on
+// from its release velocity, slowing down exponentially with this time
+// constant (in ms), until its speed drops below FLING_MIN_SPEED (pixels/ms).
+#ifndef FLING_TIME_CONSTANT
+#define FLING_TIME_CONSTANT 325
+#endif
+#ifndef FLING_MIN_SPEED
+#define FLING_MIN_SPEED   0.05
+#endif
+
+// The number of recent positions kept for each contact, to estimate its
+// velocity and acceleration.
+#ifndef VELOCITY_SAMPLES
+#define VELOCITY_SAMPLES  8
+#endif
+
+// Input conditioning defaults (see setFilter etc.). The jitter filter's
+// minimum cutoff (Hz; 0 turns it off), how fast the cutoff rises with speed
+// (per pixel/s), and the cutoff used for the speed itself; the distance (pixels)
+// a tap must move to become a drag; and the contact area above which a contact
+// is taken to be a palm and ignored (0 turns it off). Contact areas are in the
+// controller's own units.
+#ifndef FILTER_CUTOFF
+#define FILTER_CUTOFF     0
+#endif
+#ifndef FILTER_BETA
+#define FILTER_BETA       0.01
+#endif
+#ifndef FILTER_D_CUTOFF
+#define FILTER_D_CUTOFF   1.0
+#endif
+#ifndef TOUCH_SLOP
+#define TOUCH_SLOP        0
+#endif
+#ifndef PALM_AREA
+#define PALM_AREA         0
+#endif
+
+// The maximum number of contacts the controller reports, and the number of
+// gestures (taps, drags, pinches) that can be tracked at once. Each gesture
+// has one contact, or two for a pinch.
+#define MAX_CONTACTS      5
+#ifndef MAX_TRACKS
+#define MAX_TRACKS        MAX_CONTACTS
+#endif
+
+// Contacts are followed by the controller's trackId. If a contact's trackId
+// disappears, it is taken to be the nearest new contact within this distance
+// (in pixels), if there is one, rather than lifted.
+#ifndef MATCH_DISTANCE
+#define MATCH_DISTANCE    40
+#endif
 
 // Maximum number of Points in a polygon region.
+#ifndef MAX_POINTS
 #define MAX_POINTS        16
+#endif
+
+// The number of nodes regions can be attached to, to move them in groups.
+#ifndef MAX_NODES
+#define MAX_NODES         8
+#endif
+
+// The number of recognisers the app can add (see addRecognizer).
+#ifndef MAX_RECOGNIZERS
+#define MAX_RECOGNIZERS   4
+#endif
+
+// Strokes (see onStroke). While a stroke is drawn, its path is kept as up to
+// STROKE_BUFFER points at least STROKE_STEP pixels apart; the spacing doubles
+// each time the buffer fills. It is then resampled to STROKE_POINTS points to
+// compare with the templates, which may be turned by up to STROKE_ANGLE degrees
+// either way to fit it.
+#ifndef STROKE_BUFFER
+#define STROKE_BUFFER     64
+#endif
+#ifndef STROKE_STEP
+#define STROKE_STEP       4
+#endif
+#ifndef STROKE_POINTS
+#define STROKE_POINTS     32
+#endif
+#ifndef STROKE_ANGLE
+#define STROKE_ANGLE      30
+#endif
 
 // The minimum scale for a pinch, so we don't pinch the scale factors
 // down to zero or go negative.
+#ifndef MIN_SCALE
 #define MIN_SCALE         0.1
+#endif
+
+// Instrumentation. With GD_INSTRUMENT set to 1, the detector times each phase
+// of its work and counts polls, callbacks and hit tests (see getStats). When it
+// is 0 none of this is compiled in. Times are taken with GD_TIMER(), which is
+// micros() unless defined otherwise, e.g. to read a cycle counter.
+#ifndef GD_INSTRUMENT
+#define GD_INSTRUMENT     0
+#endif
+#ifndef GD_TIMER
+#define GD_TIMER()        micros()
+#endif
+
+// The number of buckets in each phase's time histogram. Bucket 0 counts times
+// of 0, and bucket b times from 2^(b-1) to 2^b - 1; the last takes any longer.
+#define GD_HIST_BUCKETS   16
+
+// Fixed point numbers in Q16.16 format, as used by the fixed point pinch solver.
+typedef int32_t fixed;
+#define FIXED_ONE           ((fixed)1 << 16)
+#define FLOAT_TO_FIXED(f)   ((fixed)((f) * FIXED_ONE))
+#define FIXED_TO_FLOAT(q)   ((float)(q) * (1.0f / FIXED_ONE))
 
 // Event types. We would like to use and enum here, but C++ will not let
 // you AND or OR them.
@@ -35,23 +230,135 @@ int const   EV_TAP = 1;
 int const   EV_DRAG = 2;
 int const   EV_SWIPE = 3;
 int const   EV_PINCH = 4;
+int const   EV_STROKE = 5;
 int const   EV_RELEASED = 0x100;    // OR'd in when the event is released
 int const   EV_LONG_PRESS = 0x200;  // OR'd in when a tap is held for more than LONG_PRESS_TIME ms
+int const   EV_INERTIA = 0x400;     // OR'd in to drag updates made after release by inertia
+int const   EV_TAP_COUNTS = 0xF000; // The tap count - 1 (up to 16), OR'd in to taps
+#define EV_TAP_COUNT(type)  ((((type) & EV_TAP_COUNTS) >> 12) + 1)
 
 // The maximum number of events that can be registered
+#ifndef MAX_EVENTS
 #define MAX_EVENTS  20
+#endif
+
+// A set of registered events, one bit per event index. Higher bits are
+// higher priorities, so the top set bit is the first candidate to test.
+// Up to 32 events fit in a word; more take as many words as they need, in
+// a class that works the same way.
+#define EVENT_WORDS       ((MAX_EVENTS + 31) / 32)
+
+#if EVENT_WORDS == 1
+typedef uint32_t EventMask;
+#define EVENT_BIT(indx)   ((EventMask)1 << (indx))
+#else
+class EventMask
+{
+public:
+  EventMask() { clear(); }
+  EventMask(uint32_t bits) { clear(); w[0] = bits; }  // the first 32 events (usually none)
+
+  static EventMask bit(int indx)
+  {
+    EventMask m;
+
+    m.w[indx >> 5] = (uint32_t)1 << (indx & 31);
+    return m;
+  }
+
+  EventMask operator~() const
+  {
+    EventMask m;
+
+    for (int k = 0; k < EVENT_WORDS; k++)
+      m.w[k] = ~w[k];
+    return m;
+  }
+  EventMask &operator|=(const EventMask &o)
+  {
+    for (int k = 0; k < EVENT_WORDS; k++)
+      w[k] |= o.w[k];
+    return *this;
+  }
+  EventMask &operator&=(const EventMask &o)
+  {
+    for (int k = 0; k < EVENT_WORDS; k++)
+      w[k] &= o.w[k];
+    return *this;
+  }
+  EventMask operator|(const EventMask &o) const { EventMask m = *this; return m |= o; }
+  EventMask operator&(const EventMask &o) const { EventMask m = *this; return m &= o; }
+  bool operator==(const EventMask &o) const
+  {
+    for (int k = 0; k < EVENT_WORDS; k++)
+    {
+      if (w[k] != o.w[k])
+        return false;
+    }
+    return true;
+  }
+  bool operator!=(const EventMask &o) const { return !(*this == o); }
+  explicit operator bool() const { return *this != 0; }
+
+  uint32_t w[EVENT_WORDS];
+
+private:
+  void clear(void)
+  {
+    for (int k = 0; k < EVENT_WORDS; k++)
+      w[k] = 0;
+  }
+};
+#define EVENT_BIT(indx)   (EventMask::bit(indx))
+#endif
+
+// The maximum number of layers that can be pushed (including the base layer).
+#ifndef MAX_LAYERS
+#define MAX_LAYERS  4
+#endif
+
+// The hit map (see setHitMap). The screen is divided into square cells of
+// HIT_CELL pixels, and each cell has a list of the events whose region bounding
+// box overlaps it, so a touch only needs the exact test on those few events.
+// The lists share HIT_ENTRIES entries; an event that won't fit is tested on
+// every touch instead. Set GD_USE_HIT_MAP to 0 to leave the map out.
+#ifndef GD_USE_HIT_MAP
+#define GD_USE_HIT_MAP    1
+#endif
+#ifndef HIT_CELL
+#define HIT_CELL          32
+#endif
+#ifndef HIT_ENTRIES
+#define HIT_ENTRIES       (32 * MAX_EVENTS)
+#endif
+#define HIT_COLS          ((WIDTH + HIT_CELL - 1) / HIT_CELL)    // in the natural rotation
+#define HIT_ROWS          ((HEIGHT + HIT_CELL - 1) / HIT_CELL)
+
+#if HIT_ENTRIES >= 0xFFFF || MAX_EVENTS > 0xFFFF
+#error "The hit map's lists are indexed by uint16_t"
+#endif
 
 // Allowable constraints on drag, swipe and pinch directions.
 // They can be restricted to only horizontal or vertical. Any that
 // do not lie within the angle_tol of the allowed direction will
 // not be acted upon.
-typedef enum Constraint
+enum Constraint
 {
   CO_NONE = 0,
   CO_HORIZ,
   CO_VERT
 };
 
+// The shapes a region can have (see setRegionShape). Regions registered as
+// x, y, w, h are rectangles; those registered as Points are polygons.
+enum RegionShape
+{
+  RS_POLYGON = 0,
+  RS_RECT,
+  RS_ELLIPSE,
+  RS_ROUND_RECT
+};
+
 // A 2D point class used by the regions on onTap, etc. calls.
 class Point
 {
@@ -85,10 +392,157 @@ public:
   // Tests for point inside polygon.
   int in_polygon(Point* V, int n);
 
+  // Tests for point inside the ellipse filling a rectangle (x0, y0) to (x1, y1),
+  // and inside such a rectangle with its corners rounded off to radius r
+  // (upper-left inclusive, lower-right exclusive, as for polygons).
+  bool in_ellipse(int x0, int y0, int x1, int y1);
+  bool in_round_rect(int x0, int y0, int x1, int y1, int r);
+
 private:
   int is_left(Point P0, Point P1);
 };
 
+// A rectangle on the screen, with inclusive corners, e.g. the part of the screen
+// changed by a callback. It is empty if xmin > xmax.
+class DamageRect
+{
+public:
+  DamageRect() { clear(); }
+  DamageRect(int x0, int y0, int x1, int y1) { xmin = x0; ymin = y0; xmax = x1; ymax = y1; }
+
+  int xmin, ymin;
+  int xmax, ymax;
+
+  void clear(void) { xmin = ymin = 0; xmax = ymax = -1; }
+  bool empty(void) { return xmin > xmax || ymin > ymax; }
+
+  // Grow to take in another rectangle.
+  void add(DamageRect r);
+
+  // Shrink to lie within another rectangle.
+  void clip(DamageRect r);
+};
+
+// A contact on the touch screen, in (rotated) screen coordinates.
+typedef struct TouchContact
+{
+  int         x, y;             // Position
+  uint8_t     id;               // trackId from the touch controller
+  uint16_t    area;             // Contact area from the touch controller
+} TouchContact;
+
+// The initial contacts of a pinch, and (for the fixed point solver) the
+// inverses of the initial contact vector, worked out once when it starts.
+typedef struct PinchStart
+{
+  int         init_x0, init_y0; // Initial points of the two contacts
+  int         init_x1, init_y1;
+  int64_t     inv_len2;         // 2^46 / squared length of contact vector (0 if none)
+  int64_t     inv_dx;           // 2^32 / (init_x0 - init_x1) (0 if none)
+  int64_t     inv_dy;           // 2^32 / (init_y0 - init_y1) (0 if none)
+} PinchStart;
+
+// A stroke's path while it is being drawn, thinned out to fit a fixed buffer.
+typedef struct StrokePath
+{
+  int16_t     x[STROKE_BUFFER];   // Points kept, at least step apart
+  int16_t     y[STROKE_BUFFER];
+  int         n;                  // Number of points kept
+  int         step;               // Spacing (pixels)
+  int16_t     last_x, last_y;     // The latest point, which may not be kept
+} StrokePath;
+
+// A stroke or a template, ready to compare: STROKE_POINTS points evenly spaced
+// along it, centred on the origin and scaled so that, as a vector, it has unit
+// length (in Q14).
+typedef struct StrokeVector
+{
+  int16_t     v[2 * STROKE_POINTS]; // x0, y0, x1, y1, ...
+} StrokeVector;
+
+// A 2D affine transform, in the same forms as Point::transform:
+//   [x'] = [a11 a12 dx][x]
+//   [y'] = [a21 a22 dy][y]
+//   [1 ] = [0   0   1][1]
+class Affine
+{
+public:
+  Affine() { set(0, 0, 1, 0, 0, 1); }                     // identity
+  Affine(int dx, int dy) { set(dx, dy, 1, 0, 0, 1); }     // translation only
+  Affine(int dx, int dy, float sx, float sy) { set(dx, dy, sx, 0, 0, sy); }
+  Affine(int dx, int dy, float a11, float a12, float a21, float a22) { set(dx, dy, a11, a12, a21, a22); }
+
+  float a11, a12, a21, a22;
+  float dx, dy;
+
+  void set(float tx, float ty, float m11, float m12, float m21, float m22)
+  {
+    dx = tx;
+    dy = ty;
+    a11 = m11;
+    a12 = m12;
+    a21 = m21;
+    a22 = m22;
+  }
+
+  // Apply to a point, rounding to the nearest pixel.
+  Point apply(int x, int y)
+  {
+    return Point(floorf(a11 * x + a12 * y + dx + 0.5f), floorf(a21 * x + a22 * y + dy + 0.5f));
+  }
+
+  // Apply to n points, rounding each to the nearest pixel, or to n (x, y) pairs
+  // of floats, keeping any fractions. from and to may be the same array.
+  void apply(const Point *from, Point *to, int n);
+  void apply(const float *from, float *to, int n);
+
+  // Find the inverse transform. Returns false (and leaves inv alone) if there
+  // isn't one, e.g. a scale has gone to zero.
+  bool invert(Affine *inv);
+
+  // The bounding box of a rectangle after this transform.
+  DamageRect apply(DamageRect r);
+
+  // This transform followed by another.
+  Affine then(Affine next);
+
+  // Find the transform taking three points to three others. Returns false (and
+  // leaves this alone) if the first three are in a line.
+  bool fit(const Point *from, const Point *to);
+};
+
+// An Affine in Q16.16 fixed point, for moving many points without floats, or
+// keeping sub-pixel positions as integers. Converting from an Affine rounds
+// each coefficient to the nearest 1/65536.
+class AffineQ16
+{
+public:
+  AffineQ16() { a11 = a22 = 1 << 16; a12 = a21 = dx = dy = 0; }  // identity
+  AffineQ16(const Affine &xf);
+
+  int32_t a11, a12, a21, a22;
+  int32_t dx, dy;
+
+  // Apply to a point, rounding to the nearest pixel.
+  Point apply(int x, int y)
+  {
+    return Point
+    (
+      ((int64_t)a11 * x + (int64_t)a12 * y + dx + 0x8000) >> 16,
+      ((int64_t)a21 * x + (int64_t)a22 * y + dy + 0x8000) >> 16
+    );
+  }
+
+  // Apply to n points, or to n (x, y) pairs that are themselves in Q16.16.
+  // from and to may be the same array.
+  void apply(const Point *from, Point *to, int n);
+  void apply(const int32_t *from, int32_t *to, int n);
+
+  // As for an Affine. The inverse is found in float and converted back.
+  bool invert(AffineQ16 *inv);
+  AffineQ16 then(AffineQ16 next);
+};
+
 // Callback functions for various events. They are called with:
 // type       The event being called back on. When released, the call is made
 //            with its type OR'd with EV_RELEASED.
@@ -110,10 +564,111 @@ private:
 //            [x'] = [sx -sy dx][x]     where sx = S cos(a), sy = S sin(a)
 //            [y'] = [sy  sx dy][y]
 //            [1 ] = [0   0   1][1]
+// total      For an affine callback (see setAffineCallback), the transform since
+//            the gesture began, as for dx, dy, sx and sy above but with the
+//            translation kept to a fraction of a pixel
+// delta      The transform since the previous callback of the gesture, so that
+//            the previous total followed by it (previous.then(*delta)) is the
+//            new total. Either can be applied to the app's own geometry.
+// match      For a stroke (only called back when released), the index in the
+//            templates of the best match, or -1 if there are none
+// score      How well the stroke matches it, from 1 (exactly, apart from position
+//            and size) down to -1. Around 0.9 or more is a good match.
 
 typedef void (*TapCB)(EventType type, int indx, void *param, int x, int y);     // for both taps and long presses
 typedef void (*DragCB)(EventType type, int indx, void *param, int x, int y, int dx, int dy);  // for drags and swipes
 typedef void (*PinchCB)(EventType type, int indx, void *param, int dx, int dy, float sx, float sy);
+typedef void (*StrokeCB)(EventType type, int indx, void *param, int match, float score);
+typedef void (*AffineCB)(EventType type, int indx, void *param, const Affine *total, const Affine *delta);  // for drags, swipes and pinches
+
+// A record of a callback made by the detector, passed to any observer set with
+// setObserver(). Fields not used by the callback's type are zero (or 1 for sx/sy).
+// For a stroke, x and y are where it started, dx is the match and sx the score.
+// For a drag, swipe or pinch, tx and ty are dx and dy before they were rounded,
+// and damage is the part of the screen it changes (as from getDamage). vx, vy,
+// ax and ay are the contact's motion (as from getVelocity and getAcceleration).
+typedef struct GestureRecord
+{
+  EventType   type;
+  int         indx;
+  int         x, y;
+  int         dx, dy;
+  float       sx, sy;
+  float       tx, ty;
+  float       vx, vy;
+  float       ax, ay;
+  DamageRect  damage;
+} GestureRecord;
+
+typedef void (*ObserverCB)(const GestureRecord *rec, void *ctx);
+
+// A recogniser of the app's own, for gestures that aren't built in, such as a
+// two-finger scroll or a three-finger swipe (see addRecognizer). Its functions
+// are passed the param given when it was added, and:
+// bid        Called when contacts land, with them and any they could go with:
+//            those of taps still being held, and those the app's recognisers
+//            have. Returns how much it wants them: 0 for not at all. It must bid
+//            more than BUILTIN_BID to take them from the built-in gestures.
+// frame      Called with every frame while it has contacts, with just those,
+//            ending with a frame of no contacts once they have all lifted.
+// cancel     Called if a higher bid takes its contacts away, or it is removed
+//            while it has them (may be NULL).
+// Contacts are in screen coordinates, with any palms left out. Contacts not bid
+// for, such as those of a drag elsewhere on the screen, carry on as they were.
+#define BUILTIN_BID       1
+
+typedef int (*RecognizerBid)(void *param, unsigned long time, uint8_t contacts, const TouchContact *c);
+typedef void (*RecognizerFrame)(void *param, unsigned long time, uint8_t contacts, const TouchContact *c);
+typedef void (*RecognizerCancel)(void *param, unsigned long time);
+
+// Counts of what the input conditioning has suppressed.
+typedef struct InputStats
+{
+  unsigned long palm_contacts;    // Contact samples ignored as palms
+  unsigned long jitter_samples;   // Samples that moved, but were held still by the filter
+  unsigned long slop_samples;     // Samples of a tap moving within the touch slop
+  unsigned long still_callbacks;  // Drag and pinch updates not called back, as nothing moved
+} InputStats;
+
+// The phases of work timed by the instrumentation. POLL is the whole of a poll()
+// that scans (or processes captured samples); READ the controller read within it;
+// TRANSFORM the calibration and rotation of the points; FRAME the recognition in
+// processFrame(). HIT_TEST, PINCH (the pinch solver), STROKE (matching a stroke)
+// and CALLBACK (the user's callback, timed in dispatch() in queued mode, see
+// getCallbackStats) are included in FRAME.
+enum Phase
+{
+  PH_POLL = 0,
+  PH_READ,
+  PH_TRANSFORM,
+  PH_FRAME,
+  PH_HIT_TEST,
+  PH_PINCH,
+  PH_STROKE,
+  PH_CALLBACK,
+  PH_COUNT
+};
+
+// Times taken by one phase, in GD_TIMER() units.
+typedef struct PhaseStats
+{
+  unsigned long count;            // Number of times the phase ran
+  unsigned long total;            // Total time spent in it
+  unsigned long max;              // Longest time
+  unsigned long hist[GD_HIST_BUCKETS];  // Histogram of times (see GD_HIST_BUCKETS)
+} PhaseStats;
+
+// A snapshot of the instrumentation (see getStats).
+typedef struct GestureStats
+{
+  PhaseStats    phase[PH_COUNT];
+  unsigned long polls;            // Polls that scanned the controller or processed samples
+  unsigned long frames;           // Frames through processFrame()
+  unsigned long callbacks[EV_STROKE + 1]; // Callbacks sent, by event type
+  unsigned long hit_tests;        // Region tests made to find events
+} GestureStats;
+
+class TraceWriter;
 
 class GestureDetector : public Arduino_GigaDisplayTouch
 {
@@ -123,7 +678,123 @@ class GestureDetector : public Arduino_GigaDisplayTouch
     bool begin();
 
     // Poll for events. Call as frequently as possible at the top of loop().
-    void poll();
+    // The touch screen is scanned every SCAN_TIME ms while it is in use, and
+    // every IDLE_SCAN_TIME ms otherwise. The time (in ms, as from millis()) can
+    // be passed in, e.g. to run against a virtual clock.
+    void poll() { poll(millis()); }
+    void poll(unsigned long current_time);
+
+    // The time (as from millis()) when poll() next has anything to do, so the
+    // loop can sleep until then. In capture mode, new samples may arrive sooner.
+    unsigned long nextPollDue(void) { return next_poll; }
+
+    // Change the scan times (in ms) while the screen is in use and while idle.
+    // A scan already due later than the new time allows is brought forward.
+    void setScanTimes(unsigned long active, unsigned long idle);
+
+    // Capture mode. Instead of scanning the touch screen in
+    // poll(), samples are read when the controller interrupts, and queued with
+    // their times so a slow loop() doesn't lose or mistime them. poll() then
+    // processes all the queued samples in order. The controller has one interrupt,
+    // so only one detector can capture at a time: beginCapture returns false,
+    // and changes nothing, while another is capturing.
+    bool beginCapture(void);
+    void endCapture(void);
+
+    // Queue a sample for poll() to process in capture mode. Safe to call from an
+    // interrupt or another thread (one producer only). Returns false, and counts
+    // an overrun, if the queue is full.
+    bool pushSample(unsigned long time, uint8_t contacts, GDTpoint_t *points);
+    unsigned long captureOverruns(void) { return __atomic_load_n(&capture_overruns, __ATOMIC_RELAXED); }
+
+    // Queued mode. Instead of being made from poll(), callbacks are queued, and
+    // made when dispatch() is called, so a slow redraw doesn't hold up reading the
+    // touch screen. poll() and dispatch() can run in different threads (one each).
+    // dispatch() returns the number of callbacks made.
+    // If the queue fills up, drag and pinch updates are dropped (and counted) as
+    // later ones carry the same totals; QUEUE_RESERVE slots are kept for releases.
+    // getVelocity(), getAcceleration() and getDamage() are carried with each
+    // callback, so describe the gesture as it was when it was queued. The onXxx
+    // calls and transformRegion() are not safe to call from a dispatch() thread
+    // while poll() is running.
+    void setQueued(bool on) { queued = on; }
+    int dispatch(void);
+    unsigned long queueDrops(void) { return __atomic_load_n(&queue_drops, __ATOMIC_RELAXED); }
+
+    // Process a frame of contacts (already rotated to screen coordinates) seen at
+    // the given time. poll() calls this; it can also be used to replay a trace
+    // against a virtual clock (see GestureTrace.h).
+    void processFrame(unsigned long current_time, uint8_t contacts, TouchContact *c);
+
+    // Add a recogniser of the app's own (see RecognizerBid). Whenever contacts
+    // land, each one bids for them (and any they could go with), as do the built-in
+    // gestures (with BUILTIN_BID). The highest bid, or on a tie a recogniser that
+    // has some of them already, gets them until they lift. Whoever had them before
+    // is cancelled; a built-in tap called back as pressed is called back as released
+    // (without counting towards a multi-tap). Bids are
+    // only asked for when a contact lands, so the cost of a frame doesn't grow with
+    // the number of recognisers. Returns the recogniser's number, or -1 if there
+    // is no room.
+    int addRecognizer(RecognizerBid bid, RecognizerFrame frame, RecognizerCancel cancel = NULL, void *param = NULL);
+
+    // Remove a recogniser, at the given time (as from millis()). If it has
+    // contacts, it is cancelled, and they are ignored until they lift.
+    void removeRecognizer(int n, unsigned long time);
+
+    // Input conditioning, applied to contacts before they are recognised.
+    // setFilter    Smooth out jitter with a One Euro filter: min_cutoff (Hz) is
+    //              the cutoff when still, which rises by beta per pixel/s of
+    //              speed. Lower min_cutoff means less jitter; higher beta means
+    //              less lag. A min_cutoff of 0 turns the filter off.
+    // setTouchSlop A tap must move more than this many pixels to become a drag.
+    // setPalmArea  Contacts with a larger area are ignored. 0 turns this off.
+    // A drag or pinch is only called back when its contacts have moved.
+    void setFilter(float min_cutoff, float beta = FILTER_BETA);
+    void setTouchSlop(int pixels) { touch_slop = pixels; }
+
+    // Multi-taps. Each tap is called back with its count in the type (see
+    // EV_TAP_COUNT): 1, then 2 for a second tap close enough in time and place
+    // to the first (see MULTI_TAP_TIME), and so on. The count is known when the
+    // tap lands, so there is no delay; a region that cares about double taps
+    // takes back what it did for the single tap, if need be.
+    // setMultiTap  Change the time (ms) and distance (pixels) for a multi-tap.
+    // confirmTaps  Instead, only call back a region's taps once the count is
+    //              final: once, with EV_RELEASED, when the time for another tap
+    //              has run out. Long presses are called back as usual.
+    void setMultiTap(unsigned long time, int distance) { multi_tap_time = time; multi_tap_distance = distance; }
+    void confirmTaps(int indx, bool on);
+    void setPalmArea(uint16_t area) { palm_area = area; }
+    void getInputStats(InputStats *stats);
+    void resetInputStats(void);
+
+    // Instrumentation (see GD_INSTRUMENT). getStats takes a snapshot, resetStats
+    // zeroes everything, and dumpStats prints a few lines summarising each phase
+    // and the counters. With GD_INSTRUMENT 0, the snapshot is all zeros and
+    // nothing is printed. They belong to the thread calling poll(); but in queued
+    // mode callbacks are timed in dispatch(), so, like getDamage(), the callback
+    // phase belongs to the thread calling that. It is left out of getStats and
+    // dumpStats then, and read and zeroed with getCallbackStats and
+    // resetCallbackStats from that thread.
+#if GD_INSTRUMENT
+    void getStats(GestureStats *snap);
+    void resetStats(void);
+    void dumpStats(Print *out);
+    void getCallbackStats(PhaseStats *ps) { *ps = cb_stats; }
+    void resetCallbackStats(void) { memset(&cb_stats, 0, sizeof(cb_stats)); }
+#else
+    void getStats(GestureStats *snap) { memset(snap, 0, sizeof(*snap)); }
+    void resetStats(void) {}
+    void dumpStats(Print *out) {}
+    void getCallbackStats(PhaseStats *ps) { memset(ps, 0, sizeof(*ps)); }
+    void resetCallbackStats(void) {}
+#endif
+
+    // Record every frame seen by poll() to a trace. NULL stops recording.
+    void setRecorder(TraceWriter *writer) { recorder = writer; }
+
+    // Have an observer called with a record of every callback, just before it is
+    // made (or queued, in queued mode).
+    void setObserver(ObserverCB cb, void *ctx = NULL) { observer = cb; observer_ctx = ctx; }
 
     // Register a callback for taps or long presses. There are two versions,
     // for an upright rect and a n-Point region.
@@ -135,6 +806,7 @@ class GestureDetector : public Arduino_GigaDisplayTouch
     //              Allows overwrite/update of registration, e.g. if region changes.
     //              Higher indices have higher priority.
     // param        Any parameter to be passed to the callback functions
+#if GD_USE_TAP
     void onTap(Point *rc, int nPts, TapCB tapCB, int indx, void *param = NULL)
     {
       fill_event(EV_TAP, rc, nPts, tapCB, NULL, NULL, indx, param);
@@ -146,6 +818,7 @@ class GestureDetector : public Arduino_GigaDisplayTouch
       nPts = fill_rect_region(x, y, w, h, rc);
       fill_event(EV_TAP, rc, nPts, tapCB, NULL, NULL, indx, param);
     }
+#endif
 
     // Register a callback for drags, swipes or pinches.
     // As above, plus:
@@ -157,30 +830,44 @@ class GestureDetector : public Arduino_GigaDisplayTouch
     //              as a multiple, e.g. setting to 10 means:
     //              that dx/dy > 10 --> dy = 0 (horizontal)
     //              and dy/dx > 10 --> dx = 0 (vertical)
-    void onDrag(Point *rc, int nPts, DragCB dragCB, int indx, void *param = NULL, Constraint constraint = CO_NONE, int angle_tol = 3)
+    // For drags:
+    // inertia      If true, when the drag is released while moving it carries on,
+    //              slowing down, with updates OR'd with EV_INERTIA, until it
+    //              stops (or the screen is touched again) and is released.
+#if GD_USE_DRAG
+    void onDrag(Point *rc, int nPts, DragCB dragCB, int indx, void *param = NULL, Constraint constraint = CO_NONE, int angle_tol = 3, bool inertia = false)
     {
-      fill_event(EV_DRAG, rc, nPts, NULL, dragCB, NULL, indx, param, false, constraint, angle_tol);
+      fill_event(EV_DRAG, rc, nPts, NULL, dragCB, NULL, indx, param, false, constraint, angle_tol, 0, inertia);
     }
-    void onDrag(int x, int y, int w, int h, DragCB dragCB, int indx, void *param = NULL, Constraint constraint = CO_NONE, int angle_tol = 3)
+    void onDrag(int x, int y, int w, int h, DragCB dragCB, int indx, void *param = NULL, Constraint constraint = CO_NONE, int angle_tol = 3, bool inertia = false)
     {
       int nPts;
       Point rc[4];
       nPts = fill_rect_region(x, y, w, h, rc);
-      fill_event(EV_DRAG, rc, nPts, NULL, dragCB, NULL, indx, param, false, constraint, angle_tol);
+      fill_event(EV_DRAG, rc, nPts, NULL, dragCB, NULL, indx, param, false, constraint, angle_tol, 0, inertia);
     }
+#endif
 
-    void onSwipe(Point *rc, int nPts, DragCB dragCB, int indx, void *param = NULL, Constraint constraint = CO_NONE, int angle_tol = 1)
+    // For swipes:
+    // min_speed    The speed (in pixels/ms) the contact must be moving at when it
+    //              is released for this region to take it as a swipe.
+#if GD_USE_SWIPE
+    void onSwipe(Point *rc, int nPts, DragCB dragCB, int indx, void *param = NULL, Constraint constraint = CO_NONE, int angle_tol = 1, float min_speed = SWIPE_SPEED)
     {
-      fill_event(EV_SWIPE, rc, nPts, NULL, dragCB, NULL, indx, param, false, constraint, angle_tol);
+      fill_event(EV_SWIPE, rc, nPts, NULL, dragCB, NULL, indx, param, false, constraint, angle_tol, min_speed);
     }
-    void onSwipe(int x, int y, int w, int h, DragCB dragCB, int indx, void *param = NULL, Constraint constraint = CO_NONE, int angle_tol = 1)
+    void onSwipe(int x, int y, int w, int h, DragCB dragCB, int indx, void *param = NULL, Constraint constraint = CO_NONE, int angle_tol = 1, float min_speed = SWIPE_SPEED)
     {
       int nPts;
       Point rc[4];
       nPts = fill_rect_region(x, y, w, h, rc);
-      fill_event(EV_SWIPE, rc, nPts, NULL, dragCB, NULL, indx, param, false, constraint, angle_tol);
+      fill_event(EV_SWIPE, rc, nPts, NULL, dragCB, NULL, indx, param, false, constraint, angle_tol, min_speed);
     }
+#endif
 
+    // For pinches, the transform passed back is the total since the pinch began,
+    // through any fingers lifting and landing again.
+#if GD_USE_PINCH
     void onPinch(Point *rc, int nPts, PinchCB pinchCB, int indx, void *param = NULL, bool rotatable = false, Constraint constraint = CO_NONE, int angle_tol = 3)
     {
       fill_event(EV_PINCH, rc, nPts, NULL, NULL, pinchCB, indx, param, rotatable, constraint, angle_tol);
@@ -192,50 +879,360 @@ class GestureDetector : public Arduino_GigaDisplayTouch
       nPts = fill_rect_region(x, y, w, h, rc);
       fill_event(EV_PINCH, rc, nPts, NULL, NULL, pinchCB, indx, param, rotatable, constraint, angle_tol);
     }
+#endif
+
+    // Register a callback for strokes: shapes drawn with one finger starting in
+    // the region, such as a tick or a cross. When the finger lifts, the stroke is
+    // compared with the templates (made with stroke_template), and the callback
+    // is made with the best match and its score. The templates are not copied,
+    // so they must stay in place. A stroke takes a one-finger drag or swipe as
+    // any other event would, by its priority.
+    // templates    Array of templates and its size
+#if GD_USE_STROKE
+    void onStroke(Point *rc, int nPts, StrokeCB strokeCB, int indx, const StrokeVector *templates, int ntemplates, void *param = NULL)
+    {
+      fill_event(EV_STROKE, rc, nPts, NULL, NULL, NULL, indx, param);
+      set_stroke(indx, strokeCB, templates, ntemplates);
+    }
+    void onStroke(int x, int y, int w, int h, StrokeCB strokeCB, int indx, const StrokeVector *templates, int ntemplates, void *param = NULL)
+    {
+      int nPts;
+      Point rc[4];
+      nPts = fill_rect_region(x, y, w, h, rc);
+      fill_event(EV_STROKE, rc, nPts, NULL, NULL, NULL, indx, param);
+      set_stroke(indx, strokeCB, templates, ntemplates);
+    }
+#endif
+
+    // Call back a drag, swipe or pinch with Affine transforms instead (see AffineCB):
+    // the total since the gesture began, and the change since the last callback.
+    // A pinch's translation isn't rounded to whole pixels, so views can be moved
+    // along incrementally, or from where they started, without drifting. Passing
+    // NULL goes back to the event's usual callback.
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+    void setAffineCallback(int indx, AffineCB affineCB);
+#endif
+
+    // The velocity (pixels/ms) and acceleration (pixels/ms/ms) of the contact
+    // whose gesture is being called back, estimated from its recent positions.
+    // Call these from a drag or swipe callback; for a pinch, they refer to the
+    // first contact, and for a drag carrying on by inertia, to its slowing down.
+    void getVelocity(float *vx, float *vy) { *vx = cb_rec.vx; *vy = cb_rec.vy; }
+    void getAcceleration(float *ax, float *ay) { *ax = cb_rec.ax; *ay = cb_rec.ay; }
+
+    // The part of the screen changed by the drag, swipe or pinch being called
+    // back: the bounding box of its region before and after this update, on the
+    // screen. The update moves the region from where transformRegion() had put it
+    // when the gesture began. Returns false (and an empty rect) for a tap. Regions with no points
+    // (the whole screen) damage the whole screen.
+    bool getDamage(DamageRect *r) { *r = cb_rec.damage; return !r->empty(); }
+
+    // All the damage from callbacks since the last call, e.g. when some updates
+    // are not redrawn. Returns false if there is none.
+    bool takeDamage(DamageRect *r);
+
+    // Move, scale or rotate a registered region in place, without re-registering
+    // it. The transform (in any of the forms of Point::transform) is applied to
+    // the region as it was registered, not to its last transformed position, so
+    // the cumulative dx/dy etc. from a drag or pinch callback can be passed
+    // straight in. Any events sharing the region move with it.
+    void transformRegion(int indx, Affine xf);
+    void transformRegion(int indx, int dx, int dy)
+    {
+      transformRegion(indx, Affine(dx, dy));
+    }
+    void transformRegion(int indx, int dx, int dy, float sx, float sy)
+    {
+      transformRegion(indx, Affine(dx, dy, sx, sy));
+    }
+    void transformRegion(int indx, int dx, int dy, float a11, float a12, float a21, float a22)
+    {
+      transformRegion(indx, Affine(dx, dy, a11, a12, a21, a22));
+    }
+
+    // Make the (registered) event at indx use the region of the event at src,
+    // so that they move together. Registering indx again gives it its own region.
+    void shareRegion(int indx, int src);
+
+    // Nodes, for moving groups of regions (e.g. the controls on a panel) together.
+    // Each node has a transform, and may have a parent node whose transform is
+    // applied after its own, and so on up to the screen. A region attached to a
+    // node has the node's transforms applied after its own transformRegion().
+    // Moving a node moves everything under it, with no work per vertex; touches
+    // are taken back into each region's own coordinates in one step.
+    // setNode          Give a node (0 to MAX_NODES - 1) a parent, or -1 for none.
+    //                  Returns false if that would make a loop.
+    // transformNode    Set a node's transform within its parent, in any of the
+    //                  forms of transformRegion.
+    // attachRegion     Attach the region used by the event at indx to a node, or
+    //                  to none (-1). Registering the event again detaches it.
+    bool setNode(int node, int parent);
+    void transformNode(int node, Affine xf);
+    void transformNode(int node, int dx, int dy)
+    {
+      transformNode(node, Affine(dx, dy));
+    }
+    void transformNode(int node, int dx, int dy, float sx, float sy)
+    {
+      transformNode(node, Affine(dx, dy, sx, sy));
+    }
+    void transformNode(int node, int dx, int dy, float a11, float a12, float a21, float a22)
+    {
+      transformNode(node, Affine(dx, dy, a11, a12, a21, a22));
+    }
+    void attachRegion(int indx, int node);
+
+    // Change the shape of the region used by the event at indx to fit the
+    // bounding box it was registered with: a rectangle, the ellipse (or circle)
+    // filling it, or a rectangle with corners rounded to the given radius. These
+    // are tested without a polygon, so curved shapes need no MAX_POINTS vertices.
+    // RS_POLYGON puts back the Points it was registered with.
+    void setRegionShape(int indx, RegionShape shape, int radius = 0);
 
     // Cancel an event at the given index.
-    void cancelEvent(int indx) { events[indx].type = EV_NONE; }
+    void cancelEvent(int indx);
 
     // Ask if there is an event at the given index
     bool isEventRegistered(int indx) { return events[indx].type != EV_NONE; }
 
     // Set the screen rotation. Use with GFX::setRotation to keep coordinates in step.
-    void setRotation(int rot) { rotation = rot; }
+    // It has no effect if the rotation is fixed with GD_ROTATION.
+    void setRotation(int rot);
+
+    // Calibrate the touch screen, to correct a panel that is offset, scaled or
+    // skewed from the display. The calibration takes points as the controller
+    // reports them to where they are on the display, both in its natural
+    // rotation; it is combined with the rotation, so it costs nothing extra
+    // per touch. It can be given as a transform (e.g. worked out offline), or
+    // found from three points on the display (not in a line) and where the
+    // controller reported touches on them, in which case it returns false if
+    // the reported points are in a line.
+    void setCalibration(Affine cal);
+    bool setCalibration(const Point *reported, const Point *display);
+    Affine getCalibration(void) { return calibration; }
+
+    // Turn the hit map on or off. When on, finding the event under a touch only
+    // tests the events whose regions overlap the touched cell, instead of walking
+    // all MAX_EVENTS of them. It costs a little more work in each onXxx call.
+    // It does nothing if the map is compiled out (GD_USE_HIT_MAP is 0).
+    void setHitMap(bool on);
+
+    // Layers of registrations, e.g. for modal dialogs. Events registered with
+    // the onXxx calls go into the top layer; an event registered again (to move
+    // or change it) stays in the layer it is in. Layer 0 is the base layer.
+    // pushLayer    Start a new layer on top and return its number, or -1 if there
+    //              are already MAX_LAYERS. If modal, the layers below it are
+    //              suspended (not hit-tested) until it is popped or disabled.
+    // popLayer     Cancel all the events in the top layer and remove it, resuming
+    //              the layers below.
+    // enableLayer  Suspend or resume a layer without cancelling its events, so a
+    //              dialog's controls can be kept registered while it is closed.
+    // A tap, drag, swipe or pinch in progress when its layer is suspended is
+    // called back once as released, where it has got to, and then no more until
+    // its contacts lift, even if the layer is resumed meanwhile. A drag carrying
+    // on by inertia stops where it is. A stroke is dropped.
+    int pushLayer(bool modal = true);
+    void popLayer(void);
+    void enableLayer(int layer, bool on);
+
+    // Use the fixed point pinch solver. It gives the same results as the
+    // (default) floating point one to within rounding, but does no square roots
+    // or divides while the pinch is in progress, and copes with the contacts
+    // starting out level, upright or on top of each other.
+#if GD_USE_PINCH
+    void setFixedPointPinch(bool on) { fixed_pinch = on; }
+#endif
+
+    // Find the highest priority event of the given type (EV_TAP, etc.) whose
+    // region contains (x, y). Returns its index, or -1 if there is none.
+    int findEvent(EventType ev, int x, int y);
 
   private:
+#ifdef GD_ROTATION
+    static const int rotation = GD_ROTATION;
+#else
     int rotation = 0;
+#endif
+
+    // The calibration, and the transform from touches as the controller reports
+    // them to the screen (calibration then rotation) in Q16.16 fixed point, with
+    // a half added to the translations so the shift down rounds.
+    typedef struct TouchTransform
+    {
+      fixed       a11, a12, dx;
+      fixed       a21, a22, dy;
+    } TouchTransform;
+
+    Affine        calibration;
+    TouchTransform touch_xf;
+
+    void update_touch_xf(void);
     unsigned long last_polled = 0;
+    unsigned long next_poll = 0;
+    unsigned long scan_time = SCAN_TIME;
+    unsigned long idle_scan_time = IDLE_SCAN_TIME;
+    bool scan_active = false;     // Whether next_poll was set by scan_time
+#if GD_USE_PINCH
+    bool fixed_pinch = false;
+#endif
+    TraceWriter *recorder = NULL;
+    ObserverCB observer = NULL;
+    void *observer_ctx = NULL;
+
+    // A timestamped sample of the touch screen, and the ring of them used in
+    // capture mode. The head and tail count up forever, and are only
+    // written by the producer and consumer respectively.
+    typedef struct TouchSample
+    {
+      unsigned long   time;
+      uint8_t         contacts;
+      GDTpoint_t      points[MAX_CONTACTS];
+    } TouchSample;
+
+    static GestureDetector *capture_detector;
+    static void capture_handler(uint8_t contacts, GDTpoint_t *points);
+    bool          capturing = false;
+    TouchSample   ring[CAPTURE_SIZE];
+    uint32_t      ring_head = 0;
+    uint32_t      ring_tail = 0;
+    unsigned long capture_overruns = 0;
+    uint8_t       last_contacts = 0;
+    unsigned long last_sample_time = 0;
+
+    // The queue of callbacks for dispatch() in queued mode, as for the ring.
+    bool          queued = false;
+    GestureRecord queue[QUEUE_SIZE];
+    uint32_t      queue_head = 0;
+    uint32_t      queue_tail = 0;
+    unsigned long queue_drops = 0;
+
+    // Input conditioning
+    float         filter_cutoff = FILTER_CUTOFF;
+    float         filter_beta = FILTER_BETA;
+    int           touch_slop = TOUCH_SLOP;
+    unsigned long multi_tap_time = MULTI_TAP_TIME;
+    int           multi_tap_distance = MULTI_TAP_DISTANCE;
+    EventMask     taps_waiting = 0;   // Regions with taps waiting to be confirmed
+    uint16_t      palm_area = PALM_AREA;
+    InputStats    input_stats;
+
+#if GD_INSTRUMENT
+    GestureStats  stats;
+    PhaseStats    cb_stats;       // The callback phase, kept by whichever thread makes callbacks
+    void record_phase(int phase, unsigned long time);
+#endif
+
+    TouchSample *next_sample(void);
+    void release_sample(void);
+    void process(unsigned long current_time, uint8_t contacts, GDTpoint_t *points);
+
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+    // A timestamped position of a contact.
+    typedef struct ContactSample
+    {
+      unsigned long   time;
+      int             x, y;
+    } ContactSample;
+#endif
 
     // Struct to keep track of a contact on the touch screen.
-    typedef struct TrackedContact
+    struct TrackedContact
     {
-      int     indx;           // Which contact this is, returned from underlying library
       int     init_x, init_y; // Initial point
       int     dx, dy;         // Total movement since (init_x, init_y).
+      uint8_t id;             // The controller's trackId for this contact
+      float   fx, fy;         // Filtered position
+      float   fvx, fvy;       // Filtered velocity (pixels/s)
+      unsigned long filter_time; // Time of the last filtered sample
+      int8_t  at;             // Where it is in this frame's contacts, or -1 if lifted
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+      ContactSample hist[VELOCITY_SAMPLES]; // Ring of recent positions
+      uint8_t hist_head;      // Where the next position goes
+      uint8_t hist_count;     // Number of positions in the ring
+#endif
+      EventMask within;       // Events whose regions contain the initial point,
+      uint32_t within_gen;    // as of this reg_gen (see contact_events)
     };
 
-    // Struct to keep track of a currently progressing gesture.
-    typedef struct TrackedEvent
+#if GD_USE_DRAG
+    // A drag carrying on by inertia after its release.
+    typedef struct Fling
+    {
+      bool            active;
+      int             indx;     // The drag event
+      int             init_x, init_y; // Initial point of the drag
+      int             dx, dy;   // Total movement at release
+      float           vx, vy;   // Velocity at release (pixels/ms)
+      float           decay;    // of the velocity, as of the last step
+      unsigned long   start_time; // Time of release
+    } Fling;
+#endif
+
+    // Struct to keep track of a currently progressing gesture. Its slot stays
+    // in use after release while it carries on by inertia.
+    struct TrackedEvent
     {
       EventType       type;     // Is this a tap, long press, drag or pinch
       unsigned long   start_time; // Time in ms of initial press (used to time long presses)
       unsigned long   hold_time; // Time in ms that a tap has been held
       int             active_event; // Index of event currently being tracked or -1 if none.
+      bool            suspended; // Its layer was suspended, and it has been released
+      float           release_speed; // Speed when released (for swipes)
+      int             tap_count;  // 1 for a single tap, 2 for a double tap, etc.
       TrackedContact  cont[2];  // Up to two tracked contacts (to allow pinches)
+      int             ncont;    // Number of them in use
+#if GD_USE_PINCH
+      PinchStart      pinch;    // Initial state of a pinch
       Constraint      working_co; // Constraint used for pinch
                                 // (combines event constraint and initial contact point angle)
+      int             base_dx, base_dy; // Transform of a pinch when its contacts
+      float           base_sx, base_sy; // last changed (a finger lifted or landed)
+      int             tot_dx, tot_dy; // Total transform of a pinch, as last called back
+      float           tot_sx, tot_sy;
+      float           base_tx, base_ty; // The translations above, before rounding
+      float           tot_tx, tot_ty;
+#endif
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+      Affine          region_xf; // The event's region's own transform when it was taken
+#endif
+#if GD_USE_DRAG
+      Fling           fling;    // Inertia after release, for a drag
+#endif
+#if GD_USE_STROKE
+      StrokePath      stroke;   // The path of a one-finger gesture, for a stroke
+#endif
     };
 
     // The event structure for all registered events.
-    typedef struct RegEvent
+    struct RegEvent
     {
       EventType   type;           // What this is (tap, drag or pinch)
       void        *param;         // User parameter passed to callbacks
-      Point       reg[MAX_POINTS]; // The region it is sensitive to
+      Point       reg[MAX_POINTS + 1]; // The region it is sensitive to, closed
       int         nPts;          // Number of Points in region
+      RegionShape shape;          // How to test it (within its bounding box)
+      int         radius;         // Corner radius for a RS_ROUND_RECT
+      int         region;         // Index of event whose region this uses (normally this one)
+      bool        transformed;    // Whether the region has been transformed or attached
+      Affine      xf;             // Its own transform (from transformRegion)
+      int         node;           // The node it is attached to, or -1
+      Affine      inv_xf;         // Inverse of the whole transform, taking screen points to the region
+      int         lxmin, lymin;   // Bounding box of region as registered (inclusive)
+      int         lxmax, lymax;
+      int         xmin, ymin;     // Bounding box of region as transformed
+      int         xmax, ymax;
+      DamageRect  shown;          // Bounding box of region as last called back
       TapCB       tapCallback;    // Callback function for taps and long presses.
       DragCB      dragCallback;   // For drags and swipes
       PinchCB     pinchCallback;  // For pinches.
+      StrokeCB    strokeCallback; // For strokes, with
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+      AffineCB    affineCallback; // For drags, swipes and pinches instead, if not NULL,
+      Affine      cb_xf;          // with the total last called back,
+      bool        cb_moving;      // if the gesture hasn't been released since
+#endif
+      const StrokeVector *templates; // the templates to match them with
+      int         ntemplates;
       Constraint  constraint;     // Whether restricted to h/v drag/pinch
       int         angle_tol;      // Tolerance below which a drag or pinch
                                   // is snapped to an h/v axis, expressed
@@ -243,19 +1240,195 @@ class GestureDetector : public Arduino_GigaDisplayTouch
                                   // that dx/dy > 10 --> dy = 0 (horizontal)
                                   // and dy/dx > 10 --> dx = 0 (vertical)
       bool        rotatable;      // Whether pinch is rotatable
+      float       min_speed;      // Minimum release speed for a swipe
+      bool        inertia;        // Whether drag carries on after release
+      bool        confirm_taps;   // Whether to wait for the final tap count
+      int         tap_count;      // The count of the last tap (0 if none),
+      int         tap_x, tap_y;   // where it landed,
+      unsigned long tap_time;     // and when it was last seen
     };
 
-    TrackedEvent  track;
+    // The gestures in progress.
+    TrackedEvent  tracks[MAX_TRACKS];
+
+    // The callback being made, and the damage from all those made since the
+    // last takeDamage(). They are set as callbacks are made, so in queued mode
+    // they belong to the thread calling dispatch().
+    GestureRecord cb_rec = {};
+    DamageRect    damage;
+
     RegEvent      events[MAX_EVENTS];
 
-    void start_new_tracked(unsigned long current_time, EventType ev);
-    void call_cb(void);
+    // Nodes that regions can be attached to (see setNode).
+    typedef struct Node
+    {
+      int         parent;         // Parent node, or -1 for none
+      Affine      xf;             // Transform within the parent
+      Affine      world;          // Transform to the screen, with all the parents'
+    } Node;
+    Node          nodes[MAX_NODES];
+
+    // The app's recognisers, each with the trackIds of the contacts it has. A
+    // removed recogniser's slot stays in use until its contacts lift, so they
+    // aren't taken up by anything else. The trackIds in the last frame show
+    // when a contact lands.
+    typedef struct Recognizer
+    {
+      RecognizerBid     bid;      // NULL for an unused (or removed) slot
+      RecognizerFrame   frame;
+      RecognizerCancel  cancel;
+      void              *param;
+      uint8_t           ids[MAX_CONTACTS];
+      uint8_t           nids;
+    } Recognizer;
+
+    Recognizer    recognizers[MAX_RECOGNIZERS];
+    int           nrecognizers = 0;
+    uint8_t       seen_ids[MAX_CONTACTS];
+    uint8_t       seen_contacts = 0;
+
+    // The hit map. Each cell (y / HIT_CELL * hit_cols + x / HIT_CELL, with
+    // hit_cols the number across the screen in its current rotation) has a list
+    // of events, linked through hit_entries from hit_head, and the unused entries
+    // are linked from hit_free. Events with no region (the whole screen), and any
+    // that didn't fit in the entries, are kept in hit_all rather than in the cells.
+#if GD_USE_HIT_MAP
+    typedef struct HitEntry
+    {
+      uint16_t    indx;           // The event
+      uint16_t    next;           // The next entry in the list, or HIT_END
+    } HitEntry;
+
+    static const uint16_t HIT_END = 0xFFFF;
+    bool          use_hit_map = false;
+    int           hit_cols = HIT_COLS;
+    uint16_t      hit_head[HIT_COLS * HIT_ROWS];
+    HitEntry      hit_entries[HIT_ENTRIES];
+    uint16_t      hit_free;
+    int           hit_nfree;
+    EventMask     hit_all;
+#else
+    static const bool use_hit_map = false;
+#endif
+
+    // The layer stack. Each layer holds a set of events; active_events is the
+    // set that hit-testing considers, kept up to date by update_layers().
+    int           top_layer = 0;
+    EventMask     layer_events[MAX_LAYERS];
+    bool          layer_modal[MAX_LAYERS];
+    bool          layer_enabled[MAX_LAYERS];
+    EventMask     active_events = 0;
+
+    // Bumped whenever a region, or the set of active events, changes, so each
+    // contact's cached set of events under its initial point can be checked.
+    uint32_t      reg_gen = 0;
+
+    // The built-in gestures. Each is recognised in the manner of the app's own
+    // recognisers (see RecognizerBid), on the tracked event it has. They are
+    // listed by type in builtins[] (in gesture.cpp), which is all the tracking
+    // and calling back go through, so adding one means adding its entry there
+    // and its functions. In each (any may be NULL):
+    // bid    How much it wants to start on a contact that has just landed, c[k],
+    //        with t (a gesture of one contact), or alone if t is NULL. Among the
+    //        built-in gestures, the highest bid gets it.
+    // land   Start on c[k] in t (with t's contact, if it has one).
+    // frame  Follow its contacts, all still down.
+    // lift   Some or all of its contacts have lifted: release it, or go on with
+    //        the rest.
+    // call   Find the event it takes, if it hasn't one yet, and call it back.
+    typedef struct Builtin
+    {
+      int   (GestureDetector::*bid)(TrackedEvent *t, TouchContact *c, int k);
+      void  (GestureDetector::*land)(TrackedEvent *t, unsigned long current_time, TouchContact *c, int k);
+      void  (GestureDetector::*frame)(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+      void  (GestureDetector::*lift)(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+      void  (GestureDetector::*call)(TrackedEvent *t, EventType ev, EventType released);
+    } Builtin;
+
+    static const Builtin builtins[EV_STROKE + 1];
+
+    int tap_bid(TrackedEvent *t, TouchContact *c, int k);
+    void tap_land(TrackedEvent *t, unsigned long current_time, TouchContact *c, int k);
+    void tap_frame(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+    void tap_lift(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+    void drop_tap(TrackedEvent *t, unsigned long current_time);
+    void release_tap(TrackedEvent *t);
+    bool release_suspended(TrackedEvent *t);
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_STROKE || GD_USE_PINCH
+    void drag_frame(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+#endif
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_STROKE
+    void drag_lift(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+    void swipe_lift(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+#endif
+#if GD_USE_PINCH
+    int pinch_bid(TrackedEvent *t, TouchContact *c, int k);
+    void pinch_land(TrackedEvent *t, unsigned long current_time, TouchContact *c, int k);
+    void pinch_frame(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+    void pinch_lift(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+#endif
+
+    void start_new_tracked(TrackedEvent *t, unsigned long current_time, EventType ev);
+    void end_tracked(TrackedEvent *t, unsigned long current_time);
+    void start_contact(TrackedContact *tc, unsigned long current_time, TouchContact *c);
+    void move_contact(TrackedContact *tc, unsigned long current_time, int x, int y);
+    bool follow_one(TrackedEvent *t, unsigned long current_time, TouchContact *c);
+    bool follow_contact(TrackedContact *tc, unsigned long current_time, TouchContact *c);
+    float filter_alpha(float cutoff, float dt);
+    bool past_slop(TrackedContact *tc);
+    TrackedEvent *free_track(void);
+    EventMask busy_events(TrackedEvent *t);
+    bool waiting(void);
+    int count_tap(TrackedEvent *t, int indx);
+    void confirm_taps(unsigned long current_time);
+#if GD_USE_DRAG
+    bool start_fling(TrackedEvent *t, unsigned long current_time);
+    void step_fling(TrackedEvent *t, unsigned long current_time, bool stop);
+#endif
+    bool flinging(TrackedEvent *t)
+    {
+#if GD_USE_DRAG
+      return t->fling.active;
+#else
+      return false;
+#endif
+    }
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+    void estimate_motion(TrackedContact *tc, float *vx, float *vy, float *ax, float *ay);
+#endif
+    void track_frame(unsigned long current_time, uint8_t contacts, TouchContact *c);
+    void take_bids(unsigned long current_time, uint8_t contacts, TouchContact *c, bool *landed);
+    int contact_owner(uint8_t id);
+    void call_cb(TrackedEvent *t);
+
+    void tap_gesture(TrackedEvent *t, EventType ev, EventType released);
+    void drag_gesture(TrackedEvent *t, EventType ev, EventType released);
+    void pinch_gesture(TrackedEvent *t, EventType ev, EventType released);
+#if GD_USE_PINCH
+    void begin_pinch(TrackedEvent *t);
+    void compose_pinch(TrackedEvent *t, bool rotatable, int dx, int dy, float sx, float sy, float tx, float ty);
+#endif
+    int find_event(EventType ev, int x, int y, EventMask exclude);
+    int find_pinch(int x0, int y0, int x1, int y1, EventMask exclude);
+    void send_cb(EventType type, int indx, int x, int y, int dx, int dy, float sx, float sy, float tx = 0, float ty = 0, TrackedEvent *t = NULL);
+    void make_cb(const GestureRecord *rec);
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+    void make_affine_cb(const GestureRecord *rec, RegEvent *event, Affine total);
+#endif
+    bool queue_cb(const GestureRecord *rec);
+    DamageRect find_damage(EventType type, int indx, int dx, int dy, float sx, float sy, TrackedEvent *t, DamageRect *shown);
+    DamageRect screen_rect(void);
     bool in_region(RegEvent *event, int x, int y);
 
-    // Checker on dx/dy speed, rejecting any that don't fit
-    bool check_constraints(RegEvent *event, int dx, int dy);
-    // Enforcer of HV constraints on dx/dy
-    Constraint enforce_constraints(RegEvent *event, int dx, int dy, int *new_dx, int *new_dy);
+    // Hit map maintenance and lookup
+    void map_event(int indx, bool set);
+    void map_region(int owner, bool set);
+    EventMask candidates(int x, int y);
+    EventMask contact_events(TrackedContact *tc);
+    void update_layers(void);
+    void update_node(int node);
+    void set_stroke(int indx, StrokeCB strokeCB, const StrokeVector *templates, int ntemplates);
+    bool place_region(int owner);
 
     // Fill in an event of any type
     void fill_event
@@ -270,7 +1443,9 @@ class GestureDetector : public Arduino_GigaDisplayTouch
       void *param,
       bool rotatable = false,
       Constraint constraint = CO_NONE,
-      int angle_tol = 5
+      int angle_tol = 5,
+      float min_speed = 0,
+      bool inertia = false
     );
 
     int fill_rect_region(int x, int y, int w, int h, Point *rc)
@@ -298,4 +1473,57 @@ float dot(int u1, int u2, int v1, int v2);
 // Perp product of two vectors
 float perp(int u1, int u2, int v1, int v2);
 
+// Checker on dx/dy direction against an event's constraint and angle_tol,
+// rejecting any that don't fit
+bool check_constraints(Constraint constraint, int angle_tol, int dx, int dy);
+
+// Enforcer of HV constraints on dx/dy
+Constraint enforce_constraints(Constraint constraint, int angle_tol, int dx, int dy, int *new_dx, int *new_dy);
+
+// Pinch solvers. Given the pinch's initial state and the current positions of its
+// two contacts, find the translation and scales passed to a PinchCB. The float
+// version measures lengths and angles directly; the fixed point version uses the
+// inverses precomputed by pinch_start().
+void pinch_start(PinchStart *ps, int init_x0, int init_y0, int init_x1, int init_y1);
+void pinch_solve_float
+(
+  PinchStart *ps, int x0, int y0, int x1, int y1, bool rotatable, Constraint working_co,
+  int *dx, int *dy, float *sx, float *sy
+);
+void pinch_solve_fixed
+(
+  PinchStart *ps, int x0, int y0, int x1, int y1, bool rotatable, Constraint working_co,
+  int *dx, int *dy, float *sx, float *sy
+);
+
+// Strokes, compared in the manner of the Protractor recogniser. stroke_begin and
+// stroke_add follow a path as it is drawn (step 0 keeps every distinct point);
+// stroke_finish resamples it for stroke_match, which finds the best match (or -1)
+// among n templates and its score (see StrokeCB). stroke_template makes a
+// template from a path given as Points. The last two return false for a path of
+// no length. Strokes are matched in the direction they are drawn, so a shape
+// that may be drawn either way needs a template for each.
+void stroke_begin(StrokePath *s, int x, int y, int step = STROKE_STEP);
+void stroke_add(StrokePath *s, int x, int y);
+bool stroke_finish(StrokeVector *v, const StrokePath *s);
+bool stroke_template(StrokeVector *v, const Point *pts, int n);
+int stroke_match(const StrokeVector *v, const StrokeVector *templates, int n, float *score);
+
+// Index of the highest priority event in a (non-empty) mask
+#if EVENT_WORDS == 1
+inline int top_event(EventMask m)
+{
+  return 31 - __builtin_clz(m);
+}
+#else
+inline int top_event(const EventMask &m)
+{
+  int k;
+
+  for (k = EVENT_WORDS - 1; k > 0 && m.w[k] == 0; k--)
+    ;
+  return 32 * k + 31 - __builtin_clz(m.w[k]);
+}
+#endif
+
 #endif // def GESTURE_DETECTOR_H
\ No newline at end of file
@@ -0,0 +1,97 @@
+#ifndef GESTURE_TRACE_H
+#define GESTURE_TRACE_H
+
+#include "GestureDetector.h"
+
+// Touch traces. A trace records the frames of contacts seen by poll(), after
+// rotation, with their times. It can be replayed through processFrame() to
+// reproduce exactly the same callbacks, without a touch screen or real clock.
+//
+// The format is little-endian throughout, and read strictly in order, so a
+// trace can be replayed straight from a memory-mapped file.
+//
+// Header (16 bytes):
+//    char[4]   "GDTR"
+//    uint16    version (TRACE_VERSION)
+//    uint16    width, height of the screen in its natural rotation (WIDTH and
+//              HEIGHT; a trace from a different screen isn't replayed)
+//    uint16    reserved (0)
+//    uint32    time of the first frame (ms)
+//
+// Frame (3 + 7 * contacts bytes):
+//    uint16    time since the previous frame (ms)
+//    uint8     number of contacts (up to MAX_CONTACTS), or TRACE_SKIP for a
+//              frame that only advances the time (for gaps longer than 65535 ms)
+// followed by each contact:
+//    uint8     trackId
+//    uint16    area
+//    int16     x, y
+
+#define TRACE_VERSION       1
+#define TRACE_HEADER_SIZE   16
+#define TRACE_SKIP          0xFF
+
+// Where a TraceWriter sends its output, e.g. a file. Returns the number
+// of bytes written.
+typedef size_t (*TraceSink)(void *ctx, const uint8_t *data, size_t len);
+
+class TraceWriter
+{
+  public:
+    // Write into a buffer in memory, or to a sink.
+    TraceWriter(uint8_t *buf, size_t size) : buf(buf), size(size) {}
+    TraceWriter(TraceSink sink, void *ctx) : sink(sink), sink_ctx(ctx) {}
+
+    // Start a new trace. The header is written along with the first frame, which
+    // is added by the detector (see setRecorder) or by calling frame().
+    void begin(void) { started = false; failed = false; written = 0; }
+    void frame(unsigned long time, uint8_t contacts, TouchContact *c);
+
+    // The number of bytes written, and whether any could not be.
+    size_t length(void) { return written; }
+    bool overflowed(void) { return failed; }
+
+  private:
+    uint8_t       *buf = NULL;
+    size_t        size = 0;
+    TraceSink     sink = NULL;
+    void          *sink_ctx = NULL;
+    size_t        written = 0;
+    bool          started = false;
+    bool          failed = false;
+    unsigned long last_time = 0;
+
+    void put(const uint8_t *data, size_t len);
+};
+
+class TraceReader
+{
+  public:
+    // Read a trace held in memory (or mapped from a file).
+    TraceReader(const uint8_t *data, size_t len) : data(data), len(len) {}
+
+    // Check the header. Returns false if this isn't a trace we can read, or
+    // it was recorded on a screen of a different size.
+    bool begin(void);
+
+    // Read the next frame into time, contacts and c[MAX_CONTACTS]. Returns false at the end
+    // of the trace (or if it is truncated).
+    bool next(unsigned long *time, uint8_t *contacts, TouchContact *c);
+
+  private:
+    const uint8_t *data;
+    size_t        len;
+    size_t        pos = 0;
+    unsigned long time = 0;
+};
+
+// Replay a trace through a detector, calling processFrame() for every frame with
+// the frame's time as the clock. Callbacks are made as they would have been when
+// the trace was recorded. Returns the number of frames replayed, or -1 if the
+// trace header is bad (see TraceReader::begin).
+long replayTrace(GestureDetector *detector, TraceReader *reader);
+
+// Print a callback record (e.g. from an observer during replay) as one line of text.
+void printGestureRecord(Print *out, const GestureRecord *rec);
+
+#endif // def GESTURE_TRACE_H
@@ -22,6 +22,243 @@ float perp(int u1, int u2, int v1, int v2)
 
 }
 
+// Invert an affine transform.
+bool Affine::invert(Affine *inv)
+{
+	float det = a11 * a22 - a12 * a21;
+
+	if (det == 0)
+		return false;
+	inv->a11 = a22 / det;
+	inv->a12 = -a12 / det;
+	inv->a21 = -a21 / det;
+	inv->a22 = a11 / det;
+	inv->dx = -(inv->a11 * dx + inv->a12 * dy);
+	inv->dy = -(inv->a21 * dx + inv->a22 * dy);
+	return true;
+}
+
+// Compose two transforms: apply this one, then next.
+Affine Affine::then(Affine next)
+{
+	Affine r;
+
+	r.set
+	(
+		next.a11 * dx + next.a12 * dy + next.dx,
+		next.a21 * dx + next.a22 * dy + next.dy,
+		next.a11 * a11 + next.a12 * a21,
+		next.a11 * a12 + next.a12 * a22,
+		next.a21 * a11 + next.a22 * a21,
+		next.a21 * a12 + next.a22 * a22
+	);
+	return r;
+}
+
+// Fit a transform to three pairs of points, by solving for each row
+// (a, b, d) of the matrix in  to = a * from.x + b * from.y + d  by Cramer's rule.
+bool Affine::fit(const Point *from, const Point *to)
+{
+	float det =
+		from[0].x * (float)(from[1].y - from[2].y)
+		+ from[1].x * (float)(from[2].y - from[0].y)
+		+ from[2].x * (float)(from[0].y - from[1].y);
+
+	if (det == 0)
+		return false;
+
+	a11 = (to[0].x * (float)(from[1].y - from[2].y) + to[1].x * (float)(from[2].y - from[0].y) + to[2].x * (float)(from[0].y - from[1].y)) / det;
+	a12 = (to[0].x * (float)(from[2].x - from[1].x) + to[1].x * (float)(from[0].x - from[2].x) + to[2].x * (float)(from[1].x - from[0].x)) / det;
+	dx = to[0].x - a11 * from[0].x - a12 * from[0].y;
+	a21 = (to[0].y * (float)(from[1].y - from[2].y) + to[1].y * (float)(from[2].y - from[0].y) + to[2].y * (float)(from[0].y - from[1].y)) / det;
+	a22 = (to[0].y * (float)(from[2].x - from[1].x) + to[1].y * (float)(from[0].x - from[2].x) + to[2].y * (float)(from[1].x - from[0].x)) / det;
+	dy = to[0].y - a21 * from[0].x - a22 * from[0].y;
+	return true;
+}
+
+// The bounding box of a rectangle's corners after a transform.
+DamageRect Affine::apply(DamageRect r)
+{
+	Point corner[4];
+	DamageRect b;
+
+	corner[0] = apply(r.xmin, r.ymin);
+	corner[1] = apply(r.xmax, r.ymin);
+	corner[2] = apply(r.xmax, r.ymax);
+	corner[3] = apply(r.xmin, r.ymax);
+	b = DamageRect(corner[0].x, corner[0].y, corner[0].x, corner[0].y);
+	for (int i = 1; i < 4; i++)
+		b.add(DamageRect(corner[i].x, corner[i].y, corner[i].x, corner[i].y));
+	return b;
+}
+
+// Transform arrays of points. Each point is read before it is written, so the
+// arrays can be the same.
+void Affine::apply(const Point *from, Point *to, int n)
+{
+	for (int i = 0; i < n; i++)
+		to[i] = apply(from[i].x, from[i].y);
+}
+
+void Affine::apply(const float *from, float *to, int n)
+{
+	for (int i = 0; i < 2 * n; i += 2)
+	{
+		float x = from[i];
+		float y = from[i + 1];
+
+		to[i] = a11 * x + a12 * y + dx;
+		to[i + 1] = a21 * x + a22 * y + dy;
+	}
+}
+
+// Round a float to Q16.16.
+static int32_t q16(float f)
+{
+	return (int32_t)floorf(f * 65536.0f + 0.5f);
+}
+
+// Multiply two Q16.16 numbers, rounding.
+static int32_t q16_mul(int32_t a, int32_t b)
+{
+	return ((int64_t)a * b + 0x8000) >> 16;
+}
+
+AffineQ16::AffineQ16(const Affine &xf)
+{
+	a11 = q16(xf.a11);
+	a12 = q16(xf.a12);
+	a21 = q16(xf.a21);
+	a22 = q16(xf.a22);
+	dx = q16(xf.dx);
+	dy = q16(xf.dy);
+}
+
+void AffineQ16::apply(const Point *from, Point *to, int n)
+{
+	for (int i = 0; i < n; i++)
+		to[i] = apply(from[i].x, from[i].y);
+}
+
+void AffineQ16::apply(const int32_t *from, int32_t *to, int n)
+{
+	for (int i = 0; i < 2 * n; i += 2)
+	{
+		int32_t x = from[i];
+		int32_t y = from[i + 1];
+
+		to[i] = q16_mul(a11, x) + q16_mul(a12, y) + dx;
+		to[i + 1] = q16_mul(a21, x) + q16_mul(a22, y) + dy;
+	}
+}
+
+bool AffineQ16::invert(AffineQ16 *inv)
+{
+	Affine xf(0, 0, a11 / 65536.0f, a12 / 65536.0f, a21 / 65536.0f, a22 / 65536.0f);
+	Affine r;
+
+	xf.dx = dx / 65536.0f;
+	xf.dy = dy / 65536.0f;
+	if (!xf.invert(&r))
+		return false;
+	*inv = AffineQ16(r);
+	return true;
+}
+
+// Compose as Affine::then, rounding each product.
+AffineQ16 AffineQ16::then(AffineQ16 next)
+{
+	AffineQ16 r;
+
+	r.dx = q16_mul(next.a11, dx) + q16_mul(next.a12, dy) + next.dx;
+	r.dy = q16_mul(next.a21, dx) + q16_mul(next.a22, dy) + next.dy;
+	r.a11 = q16_mul(next.a11, a11) + q16_mul(next.a12, a21);
+	r.a12 = q16_mul(next.a11, a12) + q16_mul(next.a12, a22);
+	r.a21 = q16_mul(next.a21, a11) + q16_mul(next.a22, a21);
+	r.a22 = q16_mul(next.a21, a12) + q16_mul(next.a22, a22);
+	return r;
+}
+
+void DamageRect::add(DamageRect r)
+{
+	if (r.empty())
+		return;
+	if (empty())
+	{
+		*this = r;
+		return;
+	}
+	xmin = min(xmin, r.xmin);
+	ymin = min(ymin, r.ymin);
+	xmax = max(xmax, r.xmax);
+	ymax = max(ymax, r.ymax);
+}
+
+void DamageRect::clip(DamageRect r)
+{
+	xmin = max(xmin, r.xmin);
+	ymin = max(ymin, r.ymin);
+	xmax = min(xmax, r.xmax);
+	ymax = min(ymax, r.ymax);
+}
+
+// Reject any drags/wipes that don't meet the constraints.
+// TODO a version for pinches.
+bool check_constraints(Constraint constraint, int angle_tol, int dx, int dy)
+{
+  if (abs(dx) != 0 && abs(dy/dx) > angle_tol)
+  {
+    // Vertical (or nearly so). Reject if we only want horizontal.
+    if (constraint == CO_HORIZ)
+      return false;
+  }
+  else if (abs(dy) != 0 && abs(dx/dy) > angle_tol)
+  {
+    // Horizontal (or nearly so). Reject if we only want vertical.
+    if (constraint == CO_VERT)
+      return false;
+  }
+  else
+  {
+    // It's in between vertical and horizontal. Only accept if CO_NONE.
+    if (constraint != CO_NONE)
+      return false;
+  }
+  return true;
+}
+
+// Adjust the dx/dy of a drag or pinch to constraints and angle_tol.
+// This version cannot reject an event but only modify it.
+// Return the constraint that was either enforced or impled by the angle_tol.
+Constraint enforce_constraints(Constraint constraint, int angle_tol, int dx, int dy, int *new_dx, int *new_dy)
+{
+  *new_dx = dx;
+  *new_dy = dy;
+  if (constraint == CO_VERT)         // TODO snap sx/sy here for pinches likewise
+  {
+    *new_dx = 0;
+    return CO_VERT;
+  }
+  else if (constraint == CO_HORIZ)
+  {
+    *new_dy = 0;
+    return CO_HORIZ;
+  }
+  else if (abs(dx) == 0 || abs(dy/dx) > angle_tol)
+  {
+    *new_dx = 0;
+    return CO_VERT;
+  }
+  else if (abs(dy) == 0 || abs(dx/dy) > angle_tol)
+  {
+    *new_dy = 0;
+    return CO_HORIZ;
+  }
+
+  return CO_NONE;
+}
+
+
 // Helpers for point-in-polygon test.
 // From Sunday, "Inclusion of a point in a polygon" http://geomalgorithms.com/a03-_inclusion.html
 // isLeft(): tests if a point is Left|On|Right of an infinite line.
@@ -65,3 +302,361 @@ int Point::in_polygon(Point* V, int n)
     }
     return wn;
 }
+
+// Find if a point is in the ellipse filling a rectangle. Working in doubled
+// coordinates keeps the centre on a whole number, and 64 bits hold the squares.
+bool Point::in_ellipse(int x0, int y0, int x1, int y1)
+{
+	int64_t w = x1 - x0, h = y1 - y0;
+	int64_t u = 2 * x - (x0 + x1), v = 2 * y - (y0 + y1);
+
+	return u * u * h * h + v * v * w * w < w * w * h * h;
+}
+
+// Find if a point is in a rounded rectangle. Only near a corner does it need
+// to be within r of the rectangle inset by r.
+bool Point::in_round_rect(int x0, int y0, int x1, int y1, int r)
+{
+	int dx, dy;
+
+	if (x < x0 || x >= x1 || y < y0 || y >= y1)
+		return false;
+	dx = x - constrain(x, x0 + r, x1 - r);
+	dy = y - constrain(y, y0 + r, y1 - r);
+	return dx * dx + dy * dy <= r * r;
+}
+
+// Set up the initial state of a pinch. The fixed point solver works in Q16.16,
+// so the inverses are kept with enough extra fraction bits that multiplying by
+// them and shifting gives a Q16.16 result directly.
+void pinch_start(PinchStart *ps, int init_x0, int init_y0, int init_x1, int init_y1)
+{
+    int64_t len2 = (int64_t)(init_x1 - init_x0) * (init_x1 - init_x0)
+                   + (int64_t)(init_y1 - init_y0) * (init_y1 - init_y0);
+
+    ps->init_x0 = init_x0;
+    ps->init_y0 = init_y0;
+    ps->init_x1 = init_x1;
+    ps->init_y1 = init_y1;
+    ps->inv_len2 = (len2 != 0) ? ((int64_t)1 << 46) / len2 : 0;
+    ps->inv_dx = (init_x0 != init_x1) ? ((int64_t)1 << 32) / (init_x0 - init_x1) : 0;
+    ps->inv_dy = (init_y0 != init_y1) ? ((int64_t)1 << 32) / (init_y0 - init_y1) : 0;
+}
+
+// Floating point pinch solver.
+void pinch_solve_float
+(
+    PinchStart *ps, int x0, int y0, int x1, int y1, bool rotatable, Constraint working_co,
+    int *dx, int *dy, float *sx, float *sy
+)
+{
+    int init_x0 = ps->init_x0;
+    int init_y0 = ps->init_y0;
+    int init_x1 = ps->init_x1;
+    int init_y1 = ps->init_y1;
+
+    if (rotatable)
+    {
+        // Measure the (single) scale factor.
+        float len0 = length(init_x0, init_x1, init_y0, init_y1);
+        float len1 = length(x0, x1, y0, y1);
+        float scale = len1 / len0;
+
+        // Measure the rotation by comparing the lines between the endpoints,
+        // giving the cos and sin of the rotation angle.
+        float cosa = dot(init_x1 - init_x0, x1 - x0, init_y1 - init_y0, y1 - y0);
+        cosa = (cosa / len1) / len0;
+
+        float sina = perp(init_x1 - init_x0, x1 - x0, init_y1 - init_y0, y1 - y0);
+        sina = (sina / len1) / len0;
+
+        // Calculate the translation components
+        if (scale < MIN_SCALE)
+            scale = MIN_SCALE;
+        *sx = cosa * scale;
+        *sy = sina * scale;
+        *dx = x0 - (*sx * init_x0 - *sy * init_y0);
+        *dy = y0 - (*sy * init_x0 + *sx * init_y0);
+    }
+    else
+    {
+        // Simpler case with two scales and no rotation. Solve 4 simultaneous
+        // equations for 4 coefficients.
+        if (working_co == CO_VERT)
+            *sx = 1.0f;
+        else
+            *sx = (float)(x0 - x1) / ((init_x0 - init_x1));
+
+        if (working_co == CO_HORIZ)
+            *sy = 1.0f;
+        else
+            *sy = (float)(y0 - y1) / ((init_y0 - init_y1));
+
+        // Calculate the translation components
+        if (*sx < MIN_SCALE)
+            *sx = MIN_SCALE;
+        if (*sy < MIN_SCALE)
+            *sy = MIN_SCALE;
+        *dx = x0 - *sx * init_x0;
+        *dy = y0 - *sy * init_y0;
+    }
+}
+
+// Fixed point pinch solver.
+void pinch_solve_fixed
+(
+    PinchStart *ps, int x0, int y0, int x1, int y1, bool rotatable, Constraint working_co,
+    int *dx, int *dy, float *sx, float *sy
+)
+{
+    fixed fsx, fsy;
+
+    if (rotatable)
+    {
+        // The scale times the cos and sin of the rotation are the dot and perp
+        // products of the initial and current contact vectors, divided by the
+        // squared length of the initial one. No lengths are needed at all.
+        int u0 = ps->init_x1 - ps->init_x0;
+        int v0 = ps->init_y1 - ps->init_y0;
+        int u1 = x1 - x0;
+        int v1 = y1 - y0;
+
+        fsx = (fixed)(((int64_t)u0 * u1 + (int64_t)v0 * v1) * ps->inv_len2 >> 30);
+        fsy = (fixed)(((int64_t)u0 * v1 - (int64_t)v0 * u1) * ps->inv_len2 >> 30);
+
+        // Clamp the scale, keeping the angle. This is the only place a square
+        // root is taken, and only while the pinch is squeezed right down.
+        int64_t scale2 = (int64_t)fsx * fsx + (int64_t)fsy * fsy;
+        int64_t min2 = (int64_t)FLOAT_TO_FIXED(MIN_SCALE) * FLOAT_TO_FIXED(MIN_SCALE);
+        if (scale2 < min2)
+        {
+            if (scale2 == 0)
+            {
+                fsx = FLOAT_TO_FIXED(MIN_SCALE);
+                fsy = 0;
+            }
+            else
+            {
+                float k = sqrt((float)min2 / (float)scale2);
+                fsx = (fixed)(fsx * k);
+                fsy = (fixed)(fsy * k);
+            }
+        }
+
+        *dx = x0 - (int)(((int64_t)fsx * ps->init_x0 - (int64_t)fsy * ps->init_y0 + FIXED_ONE / 2) >> 16);
+        *dy = y0 - (int)(((int64_t)fsy * ps->init_x0 + (int64_t)fsx * ps->init_y0 + FIXED_ONE / 2) >> 16);
+    }
+    else
+    {
+        // Two scales and no rotation. A contact pair that starts out level
+        // (or upright) has no x (or y) scale, so leave it at 1.
+        if (working_co == CO_VERT || ps->inv_dx == 0)
+            fsx = FIXED_ONE;
+        else
+            fsx = (fixed)((int64_t)(x0 - x1) * ps->inv_dx >> 16);
+
+        if (working_co == CO_HORIZ || ps->inv_dy == 0)
+            fsy = FIXED_ONE;
+        else
+            fsy = (fixed)((int64_t)(y0 - y1) * ps->inv_dy >> 16);
+
+        if (fsx < FLOAT_TO_FIXED(MIN_SCALE))
+            fsx = FLOAT_TO_FIXED(MIN_SCALE);
+        if (fsy < FLOAT_TO_FIXED(MIN_SCALE))
+            fsy = FLOAT_TO_FIXED(MIN_SCALE);
+        *dx = x0 - (int)(((int64_t)fsx * ps->init_x0 + FIXED_ONE / 2) >> 16);
+        *dy = y0 - (int)(((int64_t)fsy * ps->init_y0 + FIXED_ONE / 2) >> 16);
+    }
+
+    *sx = FIXED_TO_FLOAT(fsx);
+    *sy = FIXED_TO_FLOAT(fsy);
+}
+
+// Start following a stroke from its first point.
+void stroke_begin(StrokePath *s, int x, int y, int step)
+{
+	s->x[0] = s->last_x = x;
+	s->y[0] = s->last_y = y;
+	s->n = 1;
+	s->step = step;
+}
+
+// Add a point to a stroke, if it is far enough from the last one kept. When the
+// buffer is full, every other point is dropped and the spacing doubled, so the
+// work per point stays the same however long the stroke goes on.
+void stroke_add(StrokePath *s, int x, int y)
+{
+	int dx = x - s->x[s->n - 1];
+	int dy = y - s->y[s->n - 1];
+	int d2 = dx * dx + dy * dy;
+
+	s->last_x = x;
+	s->last_y = y;
+	if (d2 == 0 || d2 < s->step * s->step)
+		return;
+
+	if (s->n == STROKE_BUFFER)
+	{
+		for (int i = 1; i < STROKE_BUFFER / 2; i++)
+		{
+			s->x[i] = s->x[2 * i];
+			s->y[i] = s->y[2 * i];
+		}
+		s->n = STROKE_BUFFER / 2;
+		s->step = max(2 * s->step, 1);
+	}
+	s->x[s->n] = x;
+	s->y[s->n] = y;
+	s->n++;
+}
+
+// Resample a path of n points to STROKE_POINTS points evenly spaced along it,
+// then centre and scale it. Returns false if the path has no length.
+static bool stroke_vector(StrokeVector *v, const float *px, const float *py, int n)
+{
+	float ox[STROKE_POINTS], oy[STROKE_POINTS];
+	float len = 0, interval, acc = 0, ax, ay, bx, by, d, t;
+	float cx = 0, cy = 0, mag = 0;
+	int i, k;
+
+	for (i = 1; i < n; i++)
+		len += sqrt((px[i] - px[i - 1]) * (px[i] - px[i - 1]) + (py[i] - py[i - 1]) * (py[i] - py[i - 1]));
+	if (len == 0)
+	{
+		memset(v, 0, sizeof(*v));
+		return false;
+	}
+
+	// Walk along the path, putting a point down every interval.
+	interval = len / (STROKE_POINTS - 1);
+	ax = ox[0] = px[0];
+	ay = oy[0] = py[0];
+	for (i = 1, k = 1; i < n && k < STROKE_POINTS; )
+	{
+		bx = px[i];
+		by = py[i];
+		d = sqrt((bx - ax) * (bx - ax) + (by - ay) * (by - ay));
+		if (d > 0 && acc + d >= interval)
+		{
+			t = (interval - acc) / d;
+			ax += t * (bx - ax);
+			ay += t * (by - ay);
+			ox[k] = ax;
+			oy[k] = ay;
+			k++;
+			acc = 0;
+		}
+		else
+		{
+			acc += d;
+			ax = bx;
+			ay = by;
+			i++;
+		}
+	}
+	for ( ; k < STROKE_POINTS; k++)
+	{
+		// Rounding can leave the last point short.
+		ox[k] = px[n - 1];
+		oy[k] = py[n - 1];
+	}
+
+	for (k = 0; k < STROKE_POINTS; k++)
+	{
+		cx += ox[k];
+		cy += oy[k];
+	}
+	cx /= STROKE_POINTS;
+	cy /= STROKE_POINTS;
+	for (k = 0; k < STROKE_POINTS; k++)
+	{
+		ox[k] -= cx;
+		oy[k] -= cy;
+		mag += ox[k] * ox[k] + oy[k] * oy[k];
+	}
+	mag = 16384 / sqrt(mag);
+	for (k = 0; k < STROKE_POINTS; k++)
+	{
+		v->v[2 * k] = lroundf(ox[k] * mag);
+		v->v[2 * k + 1] = lroundf(oy[k] * mag);
+	}
+	return true;
+}
+
+// Resample a finished stroke, including its last point.
+bool stroke_finish(StrokeVector *v, const StrokePath *s)
+{
+	float px[STROKE_BUFFER + 1], py[STROKE_BUFFER + 1];
+	int n;
+
+	for (n = 0; n < s->n; n++)
+	{
+		px[n] = s->x[n];
+		py[n] = s->y[n];
+	}
+	if (s->last_x != s->x[n - 1] || s->last_y != s->y[n - 1])
+	{
+		px[n] = s->last_x;
+		py[n] = s->last_y;
+		n++;
+	}
+	return stroke_vector(v, px, py, n);
+}
+
+// Make a template from a path. Long paths are thinned out as if they were drawn.
+bool stroke_template(StrokeVector *v, const Point *pts, int n)
+{
+	StrokePath s;
+
+	if (n < 1)
+	{
+		memset(v, 0, sizeof(*v));
+		return false;
+	}
+	stroke_begin(&s, pts[0].x, pts[0].y, 0);
+	for (int i = 1; i < n; i++)
+		stroke_add(&s, pts[i].x, pts[i].y);
+	return stroke_finish(v, &s);
+}
+
+// Find the template most like a stroke. Each is compared by the cosine of the
+// angle between them as vectors, having been turned to fit the stroke as well
+// as it can within STROKE_ANGLE; for unit vectors, that comes straight from
+// their dot product (a) and that with the stroke turned a right angle (b).
+// The sums are done in integers: Q14 by Q14 gives Q28, and the sums can't
+// exceed 1.0 in that.
+int stroke_match(const StrokeVector *v, const StrokeVector *templates, int n, float *score)
+{
+	const float c = cos(STROKE_ANGLE * PI / 180);
+	const float s = sin(STROKE_ANGLE * PI / 180);
+	int best = -1;
+	float best_sim = -2.0f * (1L << 28), sim, fa, fb;   // below any score, in Q28
+
+	for (int i = 0; i < n; i++)
+	{
+		const int16_t *t = templates[i].v;
+		int32_t a = 0, b = 0;
+
+		for (int j = 0; j < 2 * STROKE_POINTS; j += 2)
+		{
+			a += t[j] * v->v[j] + t[j + 1] * v->v[j + 1];
+			b += t[j] * v->v[j + 1] - t[j + 1] * v->v[j];
+		}
+
+		// The best turn is atan2(b, a). Within the limit, the cosine is then the
+		// length of (a, b); otherwise it's best at the limit nearer to it.
+		fa = a;
+		fb = fabs((float)b);
+		if (fa > 0 && fb * c <= fa * s)
+			sim = sqrt(fa * fa + fb * fb);
+		else
+			sim = fa * c + fb * s;
+		if (sim > best_sim)
+		{
+			best_sim = sim;
+			best = i;
+		}
+	}
+	*score = (best < 0) ? 0 : best_sim * (1.0f / (1L << 28));
+	return best;
+}
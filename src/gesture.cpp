@@ -1,501 +1,2375 @@
 #include "Arduino.h"
 #include "GestureDetector.h"
+#include "GestureTrace.h"
 
 // Simple ASSERT needs to flash some lights or do something at the end
 #define ASSERT(expr)  if (!(expr)) {Serial.print(__FILE__);Serial.print("(");Serial.print(__LINE__);Serial.print("): ");Serial.println(#expr);while(1);}
 
+// Instrumentation hooks, which compile to nothing unless GD_INSTRUMENT is set.
+#if GD_INSTRUMENT
+#define TIME_START(v)       unsigned long v = GD_TIMER()
+#define TIME_END(phase, v)  record_phase(phase, GD_TIMER() - v)
+#define COUNT(field)        stats.field++
+#else
+#define TIME_START(v)
+#define TIME_END(phase, v)
+#define COUNT(field)
+#endif
+
 bool GestureDetector::begin()
 {
   // Set up the tracked events and other initialisations.
-  track.type = EV_NONE;
+  for (int i = 0; i < MAX_TRACKS; i++)
+  {
+    tracks[i].type = EV_NONE;
+    tracks[i].ncont = 0;
+#if GD_USE_DRAG
+    tracks[i].fling.active = false;
+#endif
+  }
+  update_touch_xf();
+  resetInputStats();
+  resetStats();
   for (int i = 0; i < MAX_EVENTS; i++)
     events[i].type = EV_NONE;
+  for (int i = 0; i < MAX_NODES; i++)
+  {
+    nodes[i].parent = -1;
+    nodes[i].xf = nodes[i].world = Affine();
+  }
+  for (int i = 0; i < MAX_RECOGNIZERS; i++)
+  {
+    recognizers[i].bid = NULL;
+    recognizers[i].nids = 0;
+  }
+  nrecognizers = 0;
+  seen_contacts = 0;
+  setHitMap(use_hit_map);
+  top_layer = 0;
+  layer_events[0] = 0;
+  layer_modal[0] = false;
+  layer_enabled[0] = true;
+  update_layers();
 
   // Call the underlying begin()
   return Arduino_GigaDisplayTouch::begin();
 }
 
-// A helper to determine if a point (x, y) is in a rectangular region
-// (upper-left inclusive, lower-right exclusive). Points in regions with
-// zero area (zero w or h) always are considered inside. The test is only
-// caried out once, as drag callbacks might update the region.
+// A helper to determine if a point (x, y) is in a region (upper-left inclusive,
+// lower-right exclusive). Points in regions with zero area (zero w or h) always
+// are considered inside. A point outside the region's bounding box is rejected
+// before any test of its shape; for a rectangle, that is nearly all there is
+// to it. The test is only caried out once, as drag callbacks might update the region.
 bool GestureDetector::in_region(RegEvent *event, int x, int y)
 {
   Point p(x, y);
+
+  COUNT(hit_tests);
+
+  // Test against the region this event uses, which may be shared.
+  // If it has been transformed, take the point back to the region instead of
+  // transforming every vertex of the region.
+  event = &events[event->region];
   if (event->nPts == 0)
     return true;
+  if (event->transformed)
+    p = event->inv_xf.apply(x, y);
+  if (p.x < event->lxmin || p.x > event->lxmax || p.y < event->lymin || p.y > event->lymax)
+    return false;
+
+  switch (event->shape)
+  {
+  case RS_RECT:
+    return p.x < event->lxmax && p.y < event->lymax;
+  case RS_ELLIPSE:
+    return p.in_ellipse(event->lxmin, event->lymin, event->lxmax, event->lymax);
+  case RS_ROUND_RECT:
+    return p.in_round_rect(event->lxmin, event->lymin, event->lxmax, event->lymax, event->radius);
+  default:
+    return p.in_polygon(event->reg, event->nPts) != 0;
+  }
+}
+
+// Add an event to (or take it out of) the list of every hit map cell its
+// bounding box overlaps. If there aren't enough entries left for all of them,
+// it goes in hit_all, as if it had no region.
+void GestureDetector::map_event(int indx, bool set)
+{
+#if GD_USE_HIT_MAP
+  RegEvent *event = &events[events[indx].region];
+  int rows = HIT_COLS * HIT_ROWS / hit_cols;
+  int cx0, cy0, cx1, cy1, cx, cy;
+  uint16_t *link, e;
+
+  cx0 = constrain(event->xmin / HIT_CELL, 0, hit_cols - 1);
+  cy0 = constrain(event->ymin / HIT_CELL, 0, rows - 1);
+  cx1 = constrain(event->xmax / HIT_CELL, 0, hit_cols - 1);
+  cy1 = constrain(event->ymax / HIT_CELL, 0, rows - 1);
+  if (set)
+  {
+    if (event->nPts == 0 || (cx1 - cx0 + 1) * (cy1 - cy0 + 1) > hit_nfree)
+    {
+      hit_all |= EVENT_BIT(indx);
+      return;
+    }
+    for (cy = cy0; cy <= cy1; cy++)
+    {
+      for (cx = cx0; cx <= cx1; cx++)
+      {
+        e = hit_free;
+        hit_free = hit_entries[e].next;
+        hit_nfree--;
+        hit_entries[e].indx = indx;
+        hit_entries[e].next = hit_head[cy * hit_cols + cx];
+        hit_head[cy * hit_cols + cx] = e;
+      }
+    }
+    return;
+  }
+
+  if ((hit_all & EVENT_BIT(indx)) != 0)
+  {
+    hit_all &= ~EVENT_BIT(indx);
+    return;
+  }
+  for (cy = cy0; cy <= cy1; cy++)
+  {
+    for (cx = cx0; cx <= cx1; cx++)
+    {
+      for (link = &hit_head[cy * hit_cols + cx]; *link != HIT_END; link = &hit_entries[*link].next)
+      {
+        if (hit_entries[*link].indx == indx)
+        {
+          e = *link;
+          *link = hit_entries[e].next;
+          hit_entries[e].next = hit_free;
+          hit_free = e;
+          hit_nfree++;
+          break;
+        }
+      }
+    }
+  }
+#endif
+}
+
+// Map all the registered events that use the region of the event at owner.
+void GestureDetector::map_region(int owner, bool set)
+{
+  for (int i = 0; i < MAX_EVENTS; i++)
+  {
+    if (events[i].type != EV_NONE && events[i].region == owner)
+      map_event(i, set);
+  }
+}
+
+// Return the events that might contain (x, y). Without the hit map, this is
+// every active event, and the caller's tests do all the work.
+EventMask GestureDetector::candidates(int x, int y)
+{
+#if GD_USE_HIT_MAP
+  EventMask m;
+  uint16_t e;
+
+  if (use_hit_map)
+  {
+    x = constrain(x / HIT_CELL, 0, hit_cols - 1);
+    y = constrain(y / HIT_CELL, 0, HIT_COLS * HIT_ROWS / hit_cols - 1);
+    m = hit_all;
+    for (e = hit_head[y * hit_cols + x]; e != HIT_END; e = hit_entries[e].next)
+      m |= EVENT_BIT(hit_entries[e].indx);
+    return m & active_events;
+  }
+#endif
+  return active_events;
+}
+
+// Return the active events whose regions contain a contact's initial point.
+// These are found when the contact lands, and only found again if a region
+// or layer has changed since, so a gesture that has yet to settle on an event
+// (e.g. a drag outside its constraints) doesn't test the regions every poll.
+EventMask GestureDetector::contact_events(TrackedContact *tc)
+{
+  EventMask m;
+  int i;
+
+  if (tc->within_gen == reg_gen)
+    return tc->within;
+
+  TIME_START(start);
+  tc->within = 0;
+  for (m = candidates(tc->init_x, tc->init_y); m != 0; m &= ~EVENT_BIT(i))
+  {
+    i = top_event(m);
+    if (in_region(&events[i], tc->init_x, tc->init_y))
+      tc->within |= EVENT_BIT(i);
+  }
+  tc->within_gen = reg_gen;
+  TIME_END(PH_HIT_TEST, start);
+  return tc->within;
+}
+
+// Work out which events are active: those in enabled layers from the top
+// down, as far as (and including) the first enabled modal layer.
+void GestureDetector::update_layers(void)
+{
+  reg_gen++;
+  active_events = 0;
+  for (int l = top_layer; l >= 0; l--)
+  {
+    if (!layer_enabled[l])
+      continue;
+    active_events |= layer_events[l];
+    if (layer_modal[l])
+      break;
+  }
+}
+
+int GestureDetector::pushLayer(bool modal)
+{
+  if (top_layer >= MAX_LAYERS - 1)
+    return -1;
+
+  top_layer++;
+  layer_events[top_layer] = 0;
+  layer_modal[top_layer] = modal;
+  layer_enabled[top_layer] = true;
+  update_layers();
+  return top_layer;
+}
+
+void GestureDetector::popLayer(void)
+{
+  EventMask m;
+  int i;
+
+  if (top_layer == 0)
+    return;   // the base layer stays
+
+  for (m = layer_events[top_layer]; m != 0; m &= ~EVENT_BIT(i))
+  {
+    i = top_event(m);
+    cancelEvent(i);
+  }
+  top_layer--;
+  update_layers();
+}
+
+void GestureDetector::enableLayer(int layer, bool on)
+{
+  if (layer < 0 || layer > top_layer)
+    return;
+
+  layer_enabled[layer] = on;
+  update_layers();
+}
+
+void GestureDetector::setHitMap(bool on)
+{
+#if GD_USE_HIT_MAP
+  // Rebuild from scratch, as the map is not maintained while it is off.
+  // The cells run across the screen in its current rotation.
+  use_hit_map = on;
+  hit_cols = (rotation & 1) ? HIT_ROWS : HIT_COLS;
+  for (int c = 0; c < HIT_COLS * HIT_ROWS; c++)
+    hit_head[c] = HIT_END;
+  for (int e = 0; e < HIT_ENTRIES; e++)
+    hit_entries[e].next = e + 1;
+  hit_entries[HIT_ENTRIES - 1].next = HIT_END;
+  hit_free = 0;
+  hit_nfree = HIT_ENTRIES;
+  hit_all = 0;
+  if (!on)
+    return;
+  for (int i = 0; i < MAX_EVENTS; i++)
+  {
+    if (events[i].type != EV_NONE)
+      map_event(i, true);
+  }
+#endif
+}
+
+int GestureDetector::findEvent(EventType ev, int x, int y)
+{
+  return find_event(ev, x, y, 0);
+}
+
+// Find an event as above, leaving out any in the exclude mask (e.g. those
+// already taken by other gestures).
+int GestureDetector::find_event(EventType ev, int x, int y, EventMask exclude)
+{
+  EventMask m;
+  int i, found = -1;
+  TIME_START(start);
+
+  for (m = candidates(x, y) & ~exclude; m != 0; m &= ~EVENT_BIT(i))
+  {
+    i = top_event(m);
+    if (events[i].type == ev && in_region(&events[i], x, y))
+    {
+      found = i;
+      break;
+    }
+  }
+  TIME_END(PH_HIT_TEST, start);
+  return found;
+}
+
+// Find the highest priority pinch event containing both contacts, whose constraints
+// they fit, leaving out any in the exclude mask. Returns -1 if there is none.
+int GestureDetector::find_pinch(int x0, int y0, int x1, int y1, EventMask exclude)
+{
+  EventMask m;
+  int i, found = -1;
+  TIME_START(start);
+
+  m = candidates(x0, y0) & candidates(x1, y1) & ~exclude;
+  for ( ; m != 0; m &= ~EVENT_BIT(i))
+  {
+    i = top_event(m);
+    if (events[i].type != EV_PINCH)
+      continue;
+
+    // This event has two contacts, which both must be in-region
+    // and pass any H/V constraints based on their initial positions.
+    if (!in_region(&events[i], x0, y0) || !in_region(&events[i], x1, y1))
+      continue;
+    if (!check_constraints(events[i].constraint, events[i].angle_tol, x0 - x1, y0 - y1))
+      continue;
+    found = i;
+    break;
+  }
+  TIME_END(PH_HIT_TEST, start);
+  return found;
+}
+
+// Work out the count of a tap that has just landed on the event at indx: one
+// more than the last tap there, if that was close enough in time and place.
+int GestureDetector::count_tap(TrackedEvent *t, int indx)
+{
+  RegEvent *event = &events[indx];
+  int dx = t->cont[0].init_x - event->tap_x;
+  int dy = t->cont[0].init_y - event->tap_y;
+
+  if
+  (
+    event->tap_count > 0
+    && t->start_time - event->tap_time <= multi_tap_time
+    && dx * dx + dy * dy <= multi_tap_distance * multi_tap_distance
+  )
+    return event->tap_count + 1;
+  return 1;
+}
+
+// Call back the taps that were waiting for their final count, if the time for
+// another tap has run out, and there isn't one in progress.
+void GestureDetector::confirm_taps(unsigned long current_time)
+{
+  EventMask m;
+  TrackedEvent *t;
+  RegEvent *event;
+  int i;
+
+  for (m = taps_waiting; m != 0; m &= ~EVENT_BIT(i))
+  {
+    i = top_event(m);
+    event = &events[i];
+    if (current_time - event->tap_time <= multi_tap_time)
+      continue;
+    for (t = tracks; t < tracks + MAX_TRACKS; t++)
+    {
+      if (t->ncont > 0 && t->active_event == i)
+        break;
+    }
+    if (t < tracks + MAX_TRACKS)
+      continue;
+
+    taps_waiting &= ~EVENT_BIT(i);
+    send_cb(EV_TAP | EV_RELEASED | ((min(event->tap_count, 16) - 1) << 12), i, event->tap_x, event->tap_y, 0, 0, 1, 1);
+    event->tap_count = 0;
+  }
+}
+
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+void GestureDetector::setAffineCallback(int indx, AffineCB affineCB)
+{
+  if (indx >= MAX_EVENTS)
+    return;
+  events[indx].affineCallback = affineCB;
+  events[indx].cb_moving = false;
+}
+#endif
+
+void GestureDetector::confirmTaps(int indx, bool on)
+{
+  if (indx >= MAX_EVENTS || events[indx].type != EV_TAP)
+    return;
+  events[indx].confirm_taps = on;
+  if (!on && (taps_waiting & EVENT_BIT(indx)))
+  {
+    // Don't leave a tap waiting forever.
+    taps_waiting &= ~EVENT_BIT(indx);
+    send_cb(EV_TAP | EV_RELEASED | ((min(events[indx].tap_count, 16) - 1) << 12), indx, events[indx].tap_x, events[indx].tap_y, 0, 0, 1, 1);
+  }
+}
+
+// The events taken by gestures other than t, which it can't also take.
+EventMask GestureDetector::busy_events(TrackedEvent *t)
+{
+  EventMask busy = 0;
+
+  for (TrackedEvent *o = tracks; o < tracks + MAX_TRACKS; o++)
+  {
+    if (o == t)
+      continue;
+    if (o->type != EV_NONE && o->active_event >= 0)
+      busy |= EVENT_BIT(o->active_event);
+#if GD_USE_DRAG
+    if (o->fling.active)
+      busy |= EVENT_BIT(o->fling.indx);
+#endif
+  }
+  return busy;
+}
+
+// Call any valid callback function for the tracked event. Apply any constraints
+// and check if initial point(s) are inside any given regions for the registered
+// callback. An event can only be taken by one gesture at a time.
+void GestureDetector::call_cb(TrackedEvent *t)
+{
+  EventType released = t->type & EV_RELEASED;  // this is why they are const ints, not an enum
+  EventType ev = t->type & ~EV_RELEASED;
+  const Builtin *g = &builtins[ev];
+
+  // Drop the rest of a gesture released because its layer was suspended.
+  if (t->suspended || release_suspended(t))
+    return;
+
+  // The built-in gesture finds the event it takes (if it hasn't one yet) and
+  // makes the callback.
+  if (g->call != NULL)
+    (this->*g->call)(t, ev, released);
+}
+
+// If a gesture's event has been suspended with its layer, call it back once as
+// released, from where it has got to, so the app isn't left thinking it's still
+// held, and return true. A tap released this way doesn't count towards a
+// multi-tap, and a stroke, never called back until it's finished, has nothing
+// to release. A cancelled event is not called back.
+bool GestureDetector::release_suspended(TrackedEvent *t)
+{
+  EventType ev = t->type & ~EV_RELEASED;
+  const Builtin *g = &builtins[ev];
+
+  if (t->active_event < 0 || (active_events & EVENT_BIT(t->active_event)) != 0)
+    return false;
+  t->suspended = true;
+  switch (events[t->active_event].type)
+  {
+  case EV_NONE:
+  case EV_STROKE:
+    break;
+  case EV_TAP:
+    release_tap(t);
+    break;
+  default:
+    if (g->call != NULL)
+      (this->*g->call)(t, ev, EV_RELEASED);
+    break;
+  }
+  return true;
+}
+
+#if GD_USE_TAP
+// A tap or long press, possibly one of several in a row.
+void GestureDetector::tap_gesture(TrackedEvent *t, EventType ev, EventType released)
+{
+  int i;
+  EventMask m;
+  EventType count;
+
+  // Look for a matching event if we haven't already got one
+  if (t->active_event < 0)
+  {
+    m = contact_events(&t->cont[0]) & ~busy_events(t);
+    for ( ; m != 0; m &= ~EVENT_BIT(i))
+    {
+      i = top_event(m);
+      if (events[i].type == EV_TAP)
+      {
+        t->active_event = i;
+        t->tap_count = count_tap(t, i);
+        break;
+      }
+    }
+  }
+
+  if (t->active_event < 0)
+    return;   // nothing to do here
+
+#if 0
+  Serial.print("Tap ");
+  if (released)
+    Serial.print("(Rel) ");
+  Serial.print(t->active_event);
+  Serial.print(" ");
+  Serial.print(t->cont[0].init_x + t->cont[0].dx);
+  Serial.print(" ");
+  Serial.println(t->cont[0].init_y + t->cont[0].dy);
+#endif
+
+  i = t->active_event;
+  count = (min(t->tap_count, 16) - 1) << 12;   // as it goes in the type
+
+  if (t->hold_time >= LONG_PRESS_TIME)
+  {
+    // A long press ends any multi-tap.
+    if (released)
+    {
+      events[i].tap_count = 0;
+      taps_waiting &= ~EVENT_BIT(i);
+    }
+    send_cb(EV_TAP | EV_LONG_PRESS | released | count, i, t->cont[0].init_x, t->cont[0].init_y, 0, 0, 1, 1, 0, 0, t);
+    return;
+  }
+  else
+  {
+    // Remember this tap, for the next to count from.
+    if (released)
+    {
+      events[i].tap_count = t->tap_count;
+      events[i].tap_x = t->cont[0].init_x;
+      events[i].tap_y = t->cont[0].init_y;
+      events[i].tap_time = t->start_time + t->hold_time;
+    }
+    if (events[i].confirm_taps)
+    {
+      if (released)
+        taps_waiting |= EVENT_BIT(i);
+      return;
+    }
+    send_cb(EV_TAP | released | count, i, t->cont[0].init_x, t->cont[0].init_y, 0, 0, 1, 1, 0, 0, t);
+    return;
+  }
+}
+#endif
+
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_STROKE
+// A drag or swipe, or a stroke drawn by either.
+void GestureDetector::drag_gesture(TrackedEvent *t, EventType ev, EventType released)
+{
+  int i, dx, dy;
+  EventMask m;
+
+  if (t->active_event < 0)
+  {
+    // Only the direction needs checking against the events under the contact.
+    // A stroke can be drawn slowly or quickly, so takes drags and swipes alike.
+    m = contact_events(&t->cont[0]) & ~busy_events(t);
+    for ( ; m != 0; m &= ~EVENT_BIT(i))
+    {
+      i = top_event(m);
+      if (events[i].type != ev && events[i].type != EV_STROKE)
+        continue;
+      if (ev == EV_SWIPE && t->release_speed < events[i].min_speed)
+        continue;
+      if (!check_constraints(events[i].constraint, events[i].angle_tol, t->cont[0].dx, t->cont[0].dy))
+        continue;
+      t->active_event = i;
+#if GD_USE_DRAG || GD_USE_SWIPE
+      t->region_xf = events[events[i].region].xf;
+#endif
+      break;
+    }
+  }
+
+  if (t->active_event < 0)
+    return;   // nothing to do here
+
+#if GD_USE_STROKE
+  // A stroke is only called back when it's finished, with its best match.
+  if (events[t->active_event].type == EV_STROKE)
+  {
+    StrokeVector sv;
+    float score = 0;
+    int match = -1;
+
+    if (!released)
+      return;
+    i = t->active_event;
+    TIME_START(start);
+    if (stroke_finish(&sv, &t->stroke))
+      match = stroke_match(&sv, events[i].templates, events[i].ntemplates, &score);
+    TIME_END(PH_STROKE, start);
+    send_cb(EV_STROKE | released, i, t->cont[0].init_x, t->cont[0].init_y, match, 0, score, 1, 0, 0, t);
+    return;
+  }
+#endif
+
+#if 0
+  if (ev == EV_DRAG)
+    Serial.print("Drag ");
+  else
+    Serial.print("Swipe ");
+  if (released)
+    Serial.print("(Rel) ");
+  Serial.print(t->active_event);
+  Serial.print(" ");
+  Serial.print(t->cont[0].init_x + t->cont[0].dx);
+  Serial.print(" ");
+  Serial.println(t->cont[0].init_y + t->cont[0].dy);
+#endif
+
+  i = t->active_event;
+  ASSERT(events[i].type == EV_DRAG || events[i].type == EV_SWIPE);
+  enforce_constraints(events[i].constraint, events[i].angle_tol, t->cont[0].dx, t->cont[0].dy, &dx, &dy);
+  send_cb(ev | released, i, t->cont[0].init_x, t->cont[0].init_y, dx, dy, 1, 1, dx, dy, t);
+}
+#endif
+
+#if GD_USE_PINCH
+// A pinch, or what's left of one when a finger has been lifted.
+void GestureDetector::pinch_gesture(TrackedEvent *t, EventType ev, EventType released)
+{
+  int i = -1, x, y, dx, dy;
+  EventMask m;
+  float sx, sy, tx, ty;
+
+  if (t->active_event < 0)
+  {
+    // Both initial points must be in the region, and fit any H/V constraint.
+    m = contact_events(&t->cont[0]) & contact_events(&t->cont[1]) & ~busy_events(t);
+    for ( ; m != 0; m &= ~EVENT_BIT(i))
+    {
+      i = top_event(m);
+      if (events[i].type != EV_PINCH)
+        continue;
+      if (check_constraints(events[i].constraint, events[i].angle_tol, t->cont[0].init_x - t->cont[1].init_x, t->cont[0].init_y - t->cont[1].init_y))
+        break;
+    }
+    if (m != 0)
+    {
+      t->active_event = i;
+      t->region_xf = events[events[i].region].xf;
+      t->base_dx = t->base_dy = 0;
+      t->base_tx = t->base_ty = 0;
+      t->base_sx = 1;
+      t->base_sy = events[i].rotatable ? 0 : 1;
+      begin_pinch(t);
+    }
+  }
+
+  if (t->active_event < 0)
+    return;   // nothing to do here
+
+#if 0
+  Serial.print("Pinch ");
+  if (released)
+    Serial.print("(Rel) ");
+  Serial.print(t->active_event);
+  Serial.print(" ");
+  Serial.print(t->cont[0].init_x + t->cont[0].dx);
+  Serial.print(" ");
+  Serial.print(t->cont[0].init_y + t->cont[0].dy);
+  Serial.print(" ");
+  Serial.print(t->cont[1].init_x + t->cont[1].dx);
+  Serial.print(" ");
+  Serial.println(t->cont[1].init_y + t->cont[1].dy);
+#endif
+
+  i = t->active_event;
+  ASSERT(events[i].type == EV_PINCH);
+
+  if (t->ncont == 1)
+  {
+    // One finger has been lifted. The other moves the pinch along, at the
+    // scale and rotation it had then.
+    enforce_constraints(events[i].constraint, events[i].angle_tol, t->cont[0].dx, t->cont[0].dy, &dx, &dy);
+    t->tot_dx = t->base_dx + dx;
+    t->tot_dy = t->base_dy + dy;
+    t->tot_sx = t->base_sx;
+    t->tot_sy = t->base_sy;
+    t->tot_tx = t->base_tx + dx;
+    t->tot_ty = t->base_ty + dy;
+  }
+  else
+  {
+    // Handle this differently depending on whether this pinch is rotatable or not.
+    // Both solvers take the initial contacts from t->pinch.
+    TIME_START(start);
+    if (fixed_pinch)
+    {
+      pinch_solve_fixed
+      (
+        &t->pinch,
+        t->cont[0].init_x + t->cont[0].dx,
+        t->cont[0].init_y + t->cont[0].dy,
+        t->cont[1].init_x + t->cont[1].dx,
+        t->cont[1].init_y + t->cont[1].dy,
+        events[i].rotatable,
+        t->working_co,
+        &dx, &dy, &sx, &sy
+      );
+    }
+    else
+    {
+      pinch_solve_float
+      (
+        &t->pinch,
+        t->cont[0].init_x + t->cont[0].dx,
+        t->cont[0].init_y + t->cont[0].dy,
+        t->cont[1].init_x + t->cont[1].dx,
+        t->cont[1].init_y + t->cont[1].dy,
+        events[i].rotatable,
+        t->working_co,
+        &dx, &dy, &sx, &sy
+      );
+    }
+    TIME_END(PH_PINCH, start);
+
+    // The solvers round the translation to whole pixels. Find it again from the
+    // first contact, which the transform takes to exactly where it is now.
+    x = t->cont[0].init_x + t->cont[0].dx;
+    y = t->cont[0].init_y + t->cont[0].dy;
+    if (events[i].rotatable)
+    {
+      tx = x - (sx * t->pinch.init_x0 - sy * t->pinch.init_y0);
+      ty = y - (sy * t->pinch.init_x0 + sx * t->pinch.init_y0);
+    }
+    else
+    {
+      tx = x - sx * t->pinch.init_x0;
+      ty = y - sy * t->pinch.init_y0;
+    }
 
-  return p.in_polygon(event->reg, event->nPts) != 0;
+    // Follow on from the transform the pinch had when its contacts last changed.
+    compose_pinch(t, events[i].rotatable, dx, dy, sx, sy, tx, ty);
+  }
+  send_cb(EV_PINCH | released, i, 0, 0, t->tot_dx, t->tot_dy, t->tot_sx, t->tot_sy, t->tot_tx, t->tot_ty, t);
+}
+#endif
+
+// The screen in its current rotation.
+DamageRect GestureDetector::screen_rect(void)
+{
+  if (rotation & 1)
+    return DamageRect(0, 0, HEIGHT - 1, WIDTH - 1);
+  return DamageRect(0, 0, WIDTH - 1, HEIGHT - 1);
+}
+
+// A drag, swipe or pinch callback moves the region (as registered) by its transform.
+// The damage is where the region was last shown and where it is now (returned in
+// shown), clipped to the screen; it goes in the callback's record.
+DamageRect GestureDetector::find_damage(EventType type, int indx, int dx, int dy, float sx, float sy, TrackedEvent *t, DamageRect *shown)
+{
+  RegEvent *event = &events[events[indx].region];
+  DamageRect r;
+
+  *shown = event->shown;
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+  DamageRect box(event->lxmin, event->lymin, event->lxmax, event->lymax);
+  Affine xf;
+
+  switch (type & ~(EV_RELEASED | EV_INERTIA | EV_TAP_COUNTS))
+  {
+#if GD_USE_DRAG || GD_USE_SWIPE
+  case EV_DRAG:
+  case EV_SWIPE:
+    xf = Affine(dx, dy);
+    break;
+#endif
+#if GD_USE_PINCH
+  case EV_PINCH:
+    if (events[indx].rotatable)
+      xf = Affine(dx, dy, sx, -sy, sy, sx);
+    else
+      xf = Affine(dx, dy, sx, sy);
+    break;
+#endif
+  default:
+    return r;
+  }
+
+  if (event->nPts == 0)
+  {
+    r = screen_rect();
+  }
+  else
+  {
+    // The callback's transform moves the region from where its own transform
+    // had put it when the gesture took it (the app may move it along with the
+    // totals called back), and is within the region's node, if it has one, as
+    // in place_region.
+    xf = t->region_xf.then(xf);
+    if (event->node >= 0)
+      xf = xf.then(nodes[event->node].world);
+    box = xf.apply(box);
+    r = event->shown;
+    r.add(box);
+    r.clip(screen_rect());
+    *shown = box;
+  }
+#endif
+  return r;
+}
+
+bool GestureDetector::takeDamage(DamageRect *r)
+{
+  *r = damage;
+  damage.clear();
+  return !r->empty();
+}
+
+#if GD_USE_PINCH
+// Start solving a pinch from where its two contacts are now. We can set the
+// working constraint up once here, as it only depends on these points.
+void GestureDetector::begin_pinch(TrackedEvent *t)
+{
+  RegEvent *event = &events[t->active_event];
+  int dummy_dx, dummy_dy;
+
+  pinch_start
+  (
+    &t->pinch,
+    t->cont[0].init_x,
+    t->cont[0].init_y,
+    t->cont[1].init_x,
+    t->cont[1].init_y
+  );
+  t->working_co =
+    enforce_constraints
+    (
+      event->constraint,
+      event->angle_tol,
+      t->cont[0].init_x - t->cont[1].init_x,
+      t->cont[0].init_y - t->cont[1].init_y,
+      &dummy_dx,
+      &dummy_dy
+    );
+}
+
+// Apply a pinch's transform since begin_pinch() after its base transform, giving
+// its total transform. For a rotatable pinch the scales are S cos(a) and S sin(a),
+// so they multiply as complex numbers.
+void GestureDetector::compose_pinch(TrackedEvent *t, bool rotatable, int dx, int dy, float sx, float sy, float tx, float ty)
+{
+  if (rotatable)
+  {
+    t->tot_sx = sx * t->base_sx - sy * t->base_sy;
+    t->tot_sy = sy * t->base_sx + sx * t->base_sy;
+    t->tot_dx = lroundf(sx * t->base_dx - sy * t->base_dy) + dx;
+    t->tot_dy = lroundf(sy * t->base_dx + sx * t->base_dy) + dy;
+    t->tot_tx = sx * t->base_tx - sy * t->base_ty + tx;
+    t->tot_ty = sy * t->base_tx + sx * t->base_ty + ty;
+  }
+  else
+  {
+    t->tot_sx = sx * t->base_sx;
+    t->tot_sy = sy * t->base_sy;
+    t->tot_dx = lroundf(sx * t->base_dx) + dx;
+    t->tot_dy = lroundf(sy * t->base_dy) + dy;
+    t->tot_tx = sx * t->base_tx + tx;
+    t->tot_ty = sy * t->base_ty + ty;
+  }
+}
+#endif
+
+// Make a callback, or queue it in queued mode. Tell any observer about it,
+// and work out the damage it does and the motion of the gesture's (first)
+// contact, first, so they go with it. A drag carrying on by inertia has no
+// contact, and moves at its decaying fling velocity. If the callback is dropped
+// from the queue, the region is taken to be where it was, so the next update's
+// damage covers it.
+void GestureDetector::send_cb(EventType type, int indx, int x, int y, int dx, int dy, float sx, float sy, float tx, float ty, TrackedEvent *t)
+{
+  GestureRecord rec;
+  DamageRect shown;
+
+  rec.vx = rec.vy = rec.ax = rec.ay = 0;
+#if GD_USE_DRAG
+  if (t != NULL && t->ncont == 0)
+  {
+    rec.vx = t->fling.vx * t->fling.decay;
+    rec.vy = t->fling.vy * t->fling.decay;
+    rec.ax = -rec.vx / FLING_TIME_CONSTANT;
+    rec.ay = -rec.vy / FLING_TIME_CONSTANT;
+  }
+  else
+#endif
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+  if (t != NULL && t->ncont > 0)
+  {
+    estimate_motion(&t->cont[0], &rec.vx, &rec.vy, &rec.ax, &rec.ay);
+  }
+#endif
+
+  rec.damage = find_damage(type, indx, dx, dy, sx, sy, t, &shown);
+  rec.type = type;
+  rec.indx = indx;
+  rec.x = x;
+  rec.y = y;
+  rec.dx = dx;
+  rec.dy = dy;
+  rec.sx = sx;
+  rec.sy = sy;
+  rec.tx = tx;
+  rec.ty = ty;
+  COUNT(callbacks[type & 0xFF]);
+  if (observer != NULL)
+    observer(&rec, observer_ctx);
+  if (queued && !queue_cb(&rec))
+    return;
+  events[events[indx].region].shown = shown;
+  if (!queued)
+    make_cb(&rec);
+}
+
+// Make the callback described by a record. If the event has been cancelled
+// (or re-registered as another type) since, nothing is called, but its damage
+// is still taken.
+void GestureDetector::make_cb(const GestureRecord *rec)
+{
+  TIME_START(start);
+
+  cb_rec = *rec;
+  damage.add(rec->damage);
+
+#if GD_USE_TAP || GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH || GD_USE_STROKE
+  RegEvent *event = &events[rec->indx];
+
+  switch (rec->type & ~(EV_RELEASED | EV_LONG_PRESS | EV_INERTIA | EV_TAP_COUNTS))
+  {
+#if GD_USE_TAP
+  case EV_TAP:
+    if (event->type == EV_TAP)
+      event->tapCallback(rec->type, rec->indx, event->param, rec->x, rec->y);
+    break;
+#endif
+#if GD_USE_DRAG || GD_USE_SWIPE
+  case EV_DRAG:
+  case EV_SWIPE:
+    if (event->type != EV_DRAG && event->type != EV_SWIPE)
+      break;
+    if (event->affineCallback != NULL)
+      make_affine_cb(rec, event, Affine(0, 0));
+    else
+      event->dragCallback(rec->type, rec->indx, event->param, rec->x, rec->y, rec->dx, rec->dy);
+    break;
+#endif
+#if GD_USE_PINCH
+  case EV_PINCH:
+    if (event->type != EV_PINCH)
+      break;
+    if (event->affineCallback != NULL && event->rotatable)
+      make_affine_cb(rec, event, Affine(0, 0, rec->sx, -rec->sy, rec->sy, rec->sx));
+    else if (event->affineCallback != NULL)
+      make_affine_cb(rec, event, Affine(0, 0, rec->sx, rec->sy));
+    else
+      event->pinchCallback(rec->type, rec->indx, event->param, rec->dx, rec->dy, rec->sx, rec->sy);
+    break;
+#endif
+#if GD_USE_STROKE
+  case EV_STROKE:
+    if (event->type == EV_STROKE)
+      event->strokeCallback(rec->type, rec->indx, event->param, rec->dx, rec->sx);
+    break;
+#endif
+  }
+#endif
+  TIME_END(PH_CALLBACK, start);
+}
+
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+// Make an affine callback, given the total transform without its translation,
+// which is filled in unrounded. The delta is from the total last called back,
+// or from where the gesture began if it's just started.
+void GestureDetector::make_affine_cb(const GestureRecord *rec, RegEvent *event, Affine total)
+{
+  Affine inv, delta;
+
+  total.dx = rec->tx;
+  total.dy = rec->ty;
+  if (event->cb_moving && event->cb_xf.invert(&inv))
+    delta = inv.then(total);
+  else
+    delta = total;
+  event->cb_xf = total;
+  event->cb_moving = (rec->type & EV_RELEASED) == 0;
+  event->affineCallback(rec->type, rec->indx, event->param, &total, &delta);
+}
+#endif
+
+// Queue a callback for dispatch(). Like pushSample(), this is the only thing that
+// writes queue_head. When the queue is down to its last QUEUE_RESERVE slots,
+// only releases are queued; updates can be dropped as they carry the totals
+// since the gesture began, but a lost release would leave the app stuck.
+// Returns false if the callback was dropped.
+bool GestureDetector::queue_cb(const GestureRecord *rec)
+{
+  uint32_t head = queue_head;
+  uint32_t used = head - __atomic_load_n(&queue_tail, __ATOMIC_ACQUIRE);
+
+  if (used >= QUEUE_SIZE || (used >= QUEUE_SIZE - QUEUE_RESERVE && (rec->type & EV_RELEASED) == 0))
+  {
+    __atomic_fetch_add(&queue_drops, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+  queue[head & (QUEUE_SIZE - 1)] = *rec;
+  __atomic_store_n(&queue_head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+int GestureDetector::dispatch(void)
+{
+  uint32_t tail = queue_tail;
+  int n = 0;
+
+  while (tail != __atomic_load_n(&queue_head, __ATOMIC_ACQUIRE))
+  {
+    // Take a copy and hand back the slot before calling, so the callback can take its time.
+    GestureRecord rec = queue[tail & (QUEUE_SIZE - 1)];
+
+    __atomic_store_n(&queue_tail, ++tail, __ATOMIC_RELEASE);
+    make_cb(&rec);
+    n++;
+  }
+  return n;
+}
+
+// Start a new tracked event. zero out timer counter and active
+// event index, so the next call to call_cb() finds the right event.
+void GestureDetector::start_new_tracked(TrackedEvent *t, unsigned long current_time, EventType ev)
+{
+  t->start_time = current_time;
+  t->hold_time = 0;
+  t->active_event = -1;
+  t->suspended = false;
+  t->type = ev;
+}
+
+
+// Start tracking a contact from where it is now.
+void GestureDetector::start_contact(TrackedContact *tc, unsigned long current_time, TouchContact *c)
+{
+  tc->init_x = c->x;
+  tc->init_y = c->y;
+  tc->dx = tc->dy = 0;
+  tc->id = c->id;
+  tc->fx = c->x;
+  tc->fy = c->y;
+  tc->fvx = tc->fvy = 0;
+  tc->filter_time = current_time;
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+  tc->hist_count = 0;
+  tc->hist_head = 0;
+#endif
+  tc->within_gen = reg_gen - 1;
+  move_contact(tc, current_time, c->x, c->y);
+}
+
+// Update a tracked contact, and add its position to its history.
+void GestureDetector::move_contact(TrackedContact *tc, unsigned long current_time, int x, int y)
+{
+  tc->dx = x - tc->init_x;
+  tc->dy = y - tc->init_y;
+
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+  ContactSample *sample = &tc->hist[tc->hist_head];
+
+  sample->time = current_time;
+  sample->x = x;
+  sample->y = y;
+  tc->hist_head = (tc->hist_head + 1) % VELOCITY_SAMPLES;
+  if (tc->hist_count < VELOCITY_SAMPLES)
+    tc->hist_count++;
+#endif
+}
+
+#if GD_USE_DRAG
+// Start a released drag carrying on by inertia, if its event wants it and
+// it's moving fast enough. Returns true if it has started.
+bool GestureDetector::start_fling(TrackedEvent *t, unsigned long current_time)
+{
+  int i = t->active_event;
+  float vx, vy, ax, ay;
+
+  if (i < 0 || !events[i].inertia || t->suspended)
+    return false;
+  estimate_motion(&t->cont[0], &vx, &vy, &ax, &ay);
+  if (vx * vx + vy * vy < FLING_MIN_SPEED * FLING_MIN_SPEED)
+    return false;
+
+  t->fling.active = true;
+  t->fling.indx = i;
+  t->fling.init_x = t->cont[0].init_x;
+  t->fling.init_y = t->cont[0].init_y;
+  t->fling.dx = t->cont[0].dx;
+  t->fling.dy = t->cont[0].dy;
+  t->fling.vx = vx;
+  t->fling.vy = vy;
+  t->fling.decay = 1;
+  t->fling.start_time = current_time;
+  return true;
+}
+
+// Move a drag along by inertia, and call back with its new position. The
+// velocity decays as exp(-t / FLING_TIME_CONSTANT), so the position only
+// depends on the time since release, not on how often this is called.
+// When it has nearly stopped (or stop is set), release it there.
+void GestureDetector::step_fling(TrackedEvent *t, unsigned long current_time, bool stop)
+{
+  int i = t->fling.indx;
+  int dx, dy;
+  float elapsed = (long)(current_time - t->fling.start_time);
+  float decay = exp(-elapsed / FLING_TIME_CONSTANT);
+  float speed2 = (t->fling.vx * t->fling.vx + t->fling.vy * t->fling.vy) * decay * decay;
+  EventType type = EV_DRAG | EV_INERTIA;
+
+  t->fling.decay = stop ? 0 : decay;
+  if (stop || speed2 < FLING_MIN_SPEED * FLING_MIN_SPEED)
+  {
+    type = EV_DRAG | EV_RELEASED;
+    t->fling.active = false;
+  }
+
+  // Drop the fling if its event has been cancelled meanwhile, and release it
+  // where it is if its layer has been suspended.
+  if (events[i].type != EV_DRAG)
+  {
+    t->fling.active = false;
+    return;
+  }
+  if ((active_events & EVENT_BIT(i)) == 0)
+  {
+    type = EV_DRAG | EV_RELEASED;
+    t->fling.active = false;
+  }
+
+  enforce_constraints
+  (
+    events[i].constraint,
+    events[i].angle_tol,
+    t->fling.dx + t->fling.vx * FLING_TIME_CONSTANT * (1 - decay),
+    t->fling.dy + t->fling.vy * FLING_TIME_CONSTANT * (1 - decay),
+    &dx,
+    &dy
+  );
+  send_cb(type, i, t->fling.init_x, t->fling.init_y, dx, dy, 1, 1, dx, dy, t);
+}
+#endif
+
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+// Estimate the velocity (pixels/ms) and acceleration (pixels/ms/ms) of a contact
+// at its latest sample, by a least squares fit of a quadratic in time to its
+// recent history. With only two samples, or if they are too bunched up in time
+// to fit a quadratic, fit a straight line instead (no acceleration).
+void GestureDetector::estimate_motion(TrackedContact *tc, float *vx, float *vy, float *ax, float *ay)
+{
+  float s1 = 0, s2 = 0, s3 = 0, s4 = 0;   // sums of powers of t
+  float x0 = 0, x1 = 0, x2 = 0;           // sums of x, t.x, t^2.x
+  float y0 = 0, y1 = 0, y2 = 0;
+  float n = tc->hist_count;
+  float span;
+  int latest, oldest, i, k;
+  ContactSample *last;
+
+  *vx = *vy = *ax = *ay = 0;
+  if (tc->hist_count < 2)
+    return;
+
+  // Measure positions from the latest sample, and times back from it as a
+  // fraction of the time covered by the history, to keep the sums well scaled.
+  latest = (tc->hist_head + VELOCITY_SAMPLES - 1) % VELOCITY_SAMPLES;
+  oldest = (tc->hist_head + VELOCITY_SAMPLES - tc->hist_count) % VELOCITY_SAMPLES;
+  last = &tc->hist[latest];
+  span = last->time - tc->hist[oldest].time;
+  if (span <= 0)
+    return;
+  for (k = 0, i = latest; k < tc->hist_count; k++, i = (i + VELOCITY_SAMPLES - 1) % VELOCITY_SAMPLES)
+  {
+    float t = -(float)(last->time - tc->hist[i].time) / span;
+    float x = tc->hist[i].x - last->x;
+    float y = tc->hist[i].y - last->y;
+
+    s1 += t;
+    s2 += t * t;
+    s3 += t * t * t;
+    s4 += t * t * t * t;
+    x0 += x;
+    x1 += t * x;
+    x2 += t * t * x;
+    y0 += y;
+    y1 += t * y;
+    y2 += t * t * y;
+  }
+
+  // Normal equations for x = a + b.t + c.t^2, solved by Cramer's rule.
+  // The velocity is b and the acceleration 2c, at t = 0, scaled back to ms.
+  float det = n * (s2 * s4 - s3 * s3) - s1 * (s1 * s4 - s3 * s2) + s2 * (s1 * s3 - s2 * s2);
+  if (tc->hist_count >= 3 && fabs(det) > 1e-4)
+  {
+    *vx = (n * (x1 * s4 - s3 * x2) - x0 * (s1 * s4 - s3 * s2) + s2 * (s1 * x2 - x1 * s2)) / det / span;
+    *vy = (n * (y1 * s4 - s3 * y2) - y0 * (s1 * s4 - s3 * s2) + s2 * (s1 * y2 - y1 * s2)) / det / span;
+    *ax = 2 * (n * (s2 * x2 - x1 * s3) - s1 * (s1 * x2 - x1 * s2) + x0 * (s1 * s3 - s2 * s2)) / det / (span * span);
+    *ay = 2 * (n * (s2 * y2 - y1 * s3) - s1 * (s1 * y2 - y1 * s2) + y0 * (s1 * s3 - s2 * s2)) / det / (span * span);
+    return;
+  }
+
+  det = n * s2 - s1 * s1;
+  if (det != 0)
+  {
+    *vx = (n * x1 - s1 * x0) / det / span;
+    *vy = (n * y1 - s1 * y0) / det / span;
+  }
+}
+#endif
+
+// Poll for some activity.
+void GestureDetector::poll(unsigned long current_time)
+{
+  uint8_t contacts;
+  GDTpoint_t points[MAX_CONTACTS];
+
+  if (capturing)
+  {
+    // Process everything captured since last time, in order.
+    TouchSample *sample;
+    TIME_START(start);
+    COUNT(polls);
+    while ((sample = next_sample()) != NULL)
+    {
+      process(sample->time, sample->contacts, sample->points);
+      last_contacts = sample->contacts;
+      last_sample_time = sample->time;
+      release_sample();
+    }
+
+    // The controller may not interrupt when the last contact lifts, so
+    // if samples stop arriving, take it that everything has been released.
+    // (A sample may be stamped just after current_time, hence the signed test.)
+    if (last_contacts > 0 && (long)(current_time - last_sample_time) >= RELEASE_TIME)
+    {
+      process(current_time, 0, points);
+      last_contacts = 0;
+      last_polled = current_time;
+    }
+
+    // No samples arrive while nothing is touching the screen, so keep any
+    // inertia (or wait for a tap count) at the scan rate.
+    if (waiting() && last_contacts == 0 && (long)(current_time - last_polled) >= (long)scan_time)
+    {
+      process(current_time, 0, points);
+      last_polled = current_time;
+    }
+
+    scan_active = waiting() || last_contacts > 0;
+    if (waiting() && last_contacts == 0)
+      next_poll = last_polled + scan_time;
+    else if (last_contacts > 0)
+      next_poll = last_sample_time + RELEASE_TIME;
+    else
+      next_poll = current_time + idle_scan_time;
+    TIME_END(PH_POLL, start);
+    return;
+  }
+
+  // If the next scan isn't due yet, just return.
+  if ((long)(current_time - next_poll) < 0)
+    return;
+  last_polled = current_time;
+  TIME_START(start);
+  COUNT(polls);
+
+  TIME_START(read_start);
+  contacts = getTouchPoints(points);
+  TIME_END(PH_READ, read_start);
+  process(current_time, contacts, points);
+
+  // Scan quickly while anything is going on, and slowly otherwise.
+  scan_active = contacts > 0 || waiting();
+  next_poll = current_time + (scan_active ? scan_time : idle_scan_time);
+  TIME_END(PH_POLL, start);
+}
+
+// Change the scan times. The next scan is due no later than the new time after
+// the last, so a faster rate takes effect at once rather than after the old
+// (perhaps much longer) interval has run out.
+void GestureDetector::setScanTimes(unsigned long active, unsigned long idle)
+{
+  unsigned long due = last_polled + (scan_active ? active : idle);
+
+  scan_time = active;
+  idle_scan_time = idle;
+  if ((long)(next_poll - due) > 0)
+    next_poll = due;
+}
+
+// Start capturing touch samples from the controller's interrupt. Samples are
+// queued with their timestamps, and processed in order by poll().
+GestureDetector *GestureDetector::capture_detector = NULL;
+
+void GestureDetector::capture_handler(uint8_t contacts, GDTpoint_t *points)
+{
+  if (capture_detector != NULL)
+    capture_detector->pushSample(millis(), contacts, points);
+}
+
+bool GestureDetector::beginCapture(void)
+{
+  if (capture_detector != NULL && capture_detector != this)
+    return false;
+  ring_head = ring_tail = 0;
+  last_contacts = 0;
+  capture_detector = this;
+  capturing = true;
+  onDetect(capture_handler);
+  return true;
+}
+
+void GestureDetector::endCapture(void)
+{
+  capturing = false;
+  if (capture_detector == this)
+    capture_detector = NULL;
+}
+
+// Queue a sample. This is the only thing that writes ring_head, so it can be
+// called from an interrupt (or a thread) while poll() reads from the other end.
+// If the ring is full, the sample is dropped and counted.
+bool GestureDetector::pushSample(unsigned long time, uint8_t contacts, GDTpoint_t *points)
+{
+  uint32_t head = ring_head;
+
+  if (head - __atomic_load_n(&ring_tail, __ATOMIC_ACQUIRE) >= CAPTURE_SIZE)
+  {
+    __atomic_fetch_add(&capture_overruns, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+
+  TouchSample *sample = &ring[head & (CAPTURE_SIZE - 1)];
+  if (contacts > MAX_CONTACTS)
+    contacts = MAX_CONTACTS;
+  sample->time = time;
+  sample->contacts = contacts;
+  memcpy(sample->points, points, contacts * sizeof(GDTpoint_t));
+
+  // The sample must be written before it is published.
+  __atomic_store_n(&ring_head, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+// Return the oldest queued sample, or NULL if there are none. It stays in the
+// ring until release_sample() is called.
+GestureDetector::TouchSample *GestureDetector::next_sample(void)
+{
+  uint32_t tail = ring_tail;
+
+  // Don't read the sample before seeing it published.
+  if (tail == __atomic_load_n(&ring_head, __ATOMIC_ACQUIRE))
+    return NULL;
+  return &ring[tail & (CAPTURE_SIZE - 1)];
+}
+
+void GestureDetector::release_sample(void)
+{
+  // Finish reading the sample before handing back its slot.
+  __atomic_store_n(&ring_tail, ring_tail + 1, __ATOMIC_RELEASE);
+}
+
+void GestureDetector::setRotation(int rot)
+{
+#ifndef GD_ROTATION
+  rotation = rot;
+#endif
+  update_touch_xf();
+  if (use_hit_map)
+    setHitMap(true);
+}
+
+void GestureDetector::setCalibration(Affine cal)
+{
+  calibration = cal;
+  update_touch_xf();
+}
+
+bool GestureDetector::setCalibration(const Point *reported, const Point *display)
+{
+  Affine cal;
+
+  if (!cal.fit(reported, display))
+    return false;
+  setCalibration(cal);
+  return true;
+}
+
+// Work out the transform applied to every touch: the calibration, then the
+// rotation from the screen's natural orientation.
+void GestureDetector::update_touch_xf(void)
+{
+  Affine rot, xf;
+
+  switch (rotation)
+  {
+  case 0:
+    rot = Affine();
+    break;
+  case 1:
+    rot = Affine(0, WIDTH - 1, 0, 1, -1, 0);
+    break;
+  case 2:
+    rot = Affine(WIDTH - 1, HEIGHT - 1, -1, 0, 0, -1);
+    break;
+  case 3:
+    rot = Affine(HEIGHT - 1, 0, 0, -1, 1, 0);
+    break;
+  }
+
+  xf = calibration.then(rot);
+  touch_xf.a11 = lroundf(xf.a11 * FIXED_ONE);
+  touch_xf.a12 = lroundf(xf.a12 * FIXED_ONE);
+  touch_xf.dx = lroundf(xf.dx * FIXED_ONE) + FIXED_ONE / 2;
+  touch_xf.a21 = lroundf(xf.a21 * FIXED_ONE);
+  touch_xf.a22 = lroundf(xf.a22 * FIXED_ONE);
+  touch_xf.dy = lroundf(xf.dy * FIXED_ONE) + FIXED_ONE / 2;
+}
+
+// Process one sample of contacts taken at the given time.
+void GestureDetector::process(unsigned long current_time, uint8_t contacts, GDTpoint_t *points)
+{
+  TouchContact c[MAX_CONTACTS];
+
+#if 0
+    // Debugging code to print out the active contacts.
+  if (contacts > 0)
+  {
+    Serial.print("Contacts: ");
+    Serial.println(contacts);
+
+    for (uint8_t i = 0; i < contacts; i++)
+    {
+      Serial.print(i);
+      Serial.print(" ");
+      Serial.print(points[i].trackId);
+      Serial.print(" ");
+      Serial.print(points[i].x);
+      Serial.print(" ");
+      Serial.print(points[i].y);
+      Serial.print(" ");
+      Serial.println(points[i].area);
+    }
+  }
+#endif
+
+  // Calibrate and rotate the points coming back from the touch screen.
+  TIME_START(start);
+  for (uint8_t i = 0; i < contacts; i++)
+  {
+    c[i].x = (touch_xf.a11 * points[i].x + touch_xf.a12 * points[i].y + touch_xf.dx) >> 16;
+    c[i].y = (touch_xf.a21 * points[i].x + touch_xf.a22 * points[i].y + touch_xf.dy) >> 16;
+    c[i].id = points[i].trackId;
+    c[i].area = points[i].area;
+  }
+  TIME_END(PH_TRANSFORM, start);
+
+  if (recorder != NULL)
+    recorder->frame(current_time, contacts, c);
+  processFrame(current_time, contacts, c);
+}
+
+// Find a free slot for a new gesture, or NULL if they are all in use.
+GestureDetector::TrackedEvent *GestureDetector::free_track(void)
+{
+  for (TrackedEvent *t = tracks; t < tracks + MAX_TRACKS; t++)
+  {
+    if (t->type == EV_NONE && !flinging(t))
+      return t;
+  }
+  return NULL;
+}
+
+// Whether anything is waiting on the clock: a drag carrying on by inertia, or a
+// tap count to be confirmed.
+bool GestureDetector::waiting(void)
+{
+  if (taps_waiting != 0)
+    return true;
+  for (TrackedEvent *t = tracks; t < tracks + MAX_TRACKS; t++)
+  {
+    if (flinging(t))
+      return true;
+  }
+  return false;
+}
+
+// The built-in gestures, by type (see Builtin). A contact starts out as a tap,
+// and may become a drag, a swipe or (with another) a pinch. Strokes are drawn
+// by drags and swipes, so have no entry of their own.
+const GestureDetector::Builtin GestureDetector::builtins[EV_STROKE + 1] =
+{
+  // EV_NONE
+  { NULL, NULL, NULL, NULL, NULL },
+  // EV_TAP
+  {
+    &GestureDetector::tap_bid,
+    &GestureDetector::tap_land,
+    &GestureDetector::tap_frame,
+    &GestureDetector::tap_lift,
+#if GD_USE_TAP
+    &GestureDetector::tap_gesture
+#else
+    NULL
+#endif
+  },
+  // EV_DRAG. A contact moving is still followed for a pinch without any of
+  // these, so another can land to make one with it.
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_STROKE
+  {
+    NULL,
+    NULL,
+    &GestureDetector::drag_frame,
+    &GestureDetector::drag_lift,
+    &GestureDetector::drag_gesture
+  },
+#elif GD_USE_PINCH
+  { NULL, NULL, &GestureDetector::drag_frame, NULL, NULL },
+#else
+  { NULL, NULL, NULL, NULL, NULL },
+#endif
+  // EV_SWIPE, only ever seen as it's released
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_STROKE
+  {
+    NULL,
+    NULL,
+    NULL,
+    &GestureDetector::swipe_lift,
+    &GestureDetector::drag_gesture
+  },
+#else
+  { NULL, NULL, NULL, NULL, NULL },
+#endif
+  // EV_PINCH
+#if GD_USE_PINCH
+  {
+    &GestureDetector::pinch_bid,
+    &GestureDetector::pinch_land,
+    &GestureDetector::pinch_frame,
+    &GestureDetector::pinch_lift,
+    &GestureDetector::pinch_gesture
+  },
+#else
+  { NULL, NULL, NULL, NULL, NULL },
+#endif
+  // EV_STROKE
+  { NULL, NULL, NULL, NULL, NULL }
+};
+
+// Free a gesture's slot, once it has been released (though it may still carry
+// on by inertia), or when a recogniser has taken its contacts.
+void GestureDetector::end_tracked(TrackedEvent *t, unsigned long current_time)
+{
+  start_new_tracked(t, current_time, EV_NONE);
+  t->ncont = 0;
+}
+
+// Follow a gesture's one contact, adding to its stroke. Returns true if it moved.
+bool GestureDetector::follow_one(TrackedEvent *t, unsigned long current_time, TouchContact *c)
+{
+  bool moved = follow_contact(&t->cont[0], current_time, &c[t->cont[0].at]);
+
+  t->hold_time = current_time - t->start_time;
+#if GD_USE_STROKE
+  if (moved)
+    stroke_add(&t->stroke, t->cont[0].init_x + t->cont[0].dx, t->cont[0].init_y + t->cont[0].dy);
+#endif
+  return moved;
+}
+
+// Any contact landing on its own starts a tap. It could become a long press
+// or a drag later.
+int GestureDetector::tap_bid(TrackedEvent *t, TouchContact *c, int k)
+{
+  return (t == NULL) ? BUILTIN_BID : 0;
+}
+
+void GestureDetector::tap_land(TrackedEvent *t, unsigned long current_time, TouchContact *c, int k)
+{
+  start_new_tracked(t, current_time, EV_TAP);
+  start_contact(&t->cont[0], current_time, &c[k]);
+  t->cont[0].at = k;
+  t->ncont = 1;
+#if GD_USE_STROKE
+  stroke_begin(&t->stroke, c[k].x, c[k].y);
+#endif
+}
+
+// A tap whose contact a recogniser has taken. If it was called back as pressed,
+// it's called back as released, so the app doesn't think it's still held; but
+// it doesn't count towards a multi-tap.
+void GestureDetector::drop_tap(TrackedEvent *t, unsigned long current_time)
+{
+  if (t->active_event >= 0 && (active_events & EVENT_BIT(t->active_event)) != 0)
+    release_tap(t);
+  end_tracked(t, current_time);
+}
+
+// Call back a tap as released without it counting towards a multi-tap, unless
+// its event confirms its taps (and so never called it back as pressed).
+void GestureDetector::release_tap(TrackedEvent *t)
+{
+#if GD_USE_TAP
+  int i = t->active_event;
+  EventType type;
+
+  if (i >= 0 && events[i].type == EV_TAP && !events[i].confirm_taps)
+  {
+    type = EV_TAP | EV_RELEASED | ((min(t->tap_count, 16) - 1) << 12);
+    if (t->hold_time >= LONG_PRESS_TIME)
+      type |= EV_LONG_PRESS;
+    send_cb(type, i, t->cont[0].init_x, t->cont[0].init_y, 0, 0, 1, 1, 0, 0, t);
+  }
+#endif
+}
+
+// Still holding a tap. Cope with the case where the finger moves.
+void GestureDetector::tap_frame(TrackedEvent *t, unsigned long current_time, TouchContact *c)
+{
+  bool moved = follow_one(t, current_time, c);
+
+  // A tap has to move further than the touch slop before it counts.
+  if (!past_slop(&t->cont[0]))
+  {
+    if (moved)
+      input_stats.slop_samples++;
+    return;
+  }
+
+  // There is movement. This contact is promoted to a drag.
+  // If the movement is fast (it's released in <= SWIPE_TIME ms)
+  // then it becomes a swipe. Call its callback. Do not release
+  // the tap, as it isn't really a tap anyway. Update the start time
+  // for a new speed calculation now that drag has begun.
+  if (t->hold_time > SWIPE_TIME)
+  {
+    start_new_tracked(t, current_time, EV_DRAG);
+    moved = true;
+  }
+  if (!moved)
+  {
+    input_stats.still_callbacks++;
+    return;
+  }
+  call_cb(t);
+}
+
+// A tap that moved and was released quickly might be a swipe, if it was going
+// fast enough for a swipe region under it.
+void GestureDetector::tap_lift(TrackedEvent *t, unsigned long current_time, TouchContact *c)
+{
+  if (past_slop(&t->cont[0]))
+  {
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_STROKE
+    swipe_lift(t, current_time, c);
+#else
+    end_tracked(t, current_time);
+#endif
+    return;
+  }
+  t->type |= EV_RELEASED;
+  call_cb(t);
+  end_tracked(t, current_time);
+}
+
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_STROKE || GD_USE_PINCH
+void GestureDetector::drag_frame(TrackedEvent *t, unsigned long current_time, TouchContact *c)
+{
+  if (!follow_one(t, current_time, c))
+  {
+    input_stats.still_callbacks++;
+    return;
+  }
+  call_cb(t);
+}
+#endif
+
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_STROKE
+// A drag that nothing picked up might be a swipe. One with inertia is not
+// released yet if it's still moving.
+void GestureDetector::drag_lift(TrackedEvent *t, unsigned long current_time, TouchContact *c)
+{
+  if (t->active_event < 0)
+  {
+    swipe_lift(t, current_time, c);
+    return;
+  }
+#if GD_USE_DRAG
+  if (!start_fling(t, current_time))
+#endif
+  {
+    t->type |= EV_RELEASED;
+    call_cb(t);
+  }
+  end_tracked(t, current_time);
+}
+
+// A swipe is only known when it's released, by how fast it was going.
+void GestureDetector::swipe_lift(TrackedEvent *t, unsigned long current_time, TouchContact *c)
+{
+  start_new_tracked(t, current_time, EV_SWIPE);
+#if GD_USE_SWIPE
+  float vx, vy, ax, ay;
+
+  estimate_motion(&t->cont[0], &vx, &vy, &ax, &ay);
+  t->release_speed = sqrt(vx * vx + vy * vy);
+#endif
+  t->type |= EV_RELEASED;
+  call_cb(t);
+  end_tracked(t, current_time);
+}
+#endif
+
+#if GD_USE_PINCH
+// A contact makes a pinch with a tap or drag already down if both are in a
+// pinch region, and a pinch that lost a finger takes another in its region.
+// Either is wanted more than a tap.
+int GestureDetector::pinch_bid(TrackedEvent *t, TouchContact *c, int k)
+{
+  if (t == NULL)
+    return 0;
+  if (t->type == EV_PINCH)
+    return in_region(&events[t->active_event], c[k].x, c[k].y) ? BUILTIN_BID + 1 : 0;
+  if (t->type != EV_TAP && t->type != EV_DRAG)
+    return 0;
+  if
+  (
+    find_pinch
+    (
+      t->cont[0].init_x + t->cont[0].dx,
+      t->cont[0].init_y + t->cont[0].dy,
+      c[k].x,
+      c[k].y,
+      busy_events(t)
+    ) < 0
+  )
+    return 0;
+  return BUILTIN_BID + 1;
+}
+
+// Start a new pinch, or carry on with one, from where both contacts are
+// now. A drag becoming a pinch is released where it got to first.
+void GestureDetector::pinch_land(TrackedEvent *t, unsigned long current_time, TouchContact *c, int k)
+{
+  int n;
+
+  if (t->type == EV_DRAG && t->active_event >= 0)
+  {
+    t->type |= EV_RELEASED;
+    call_cb(t);
+  }
+  n = t->cont[0].at;
+  start_contact(&t->cont[0], current_time, &c[n]);
+  start_contact(&t->cont[1], current_time, &c[k]);
+  t->cont[1].at = k;
+  t->ncont = 2;
+  if (t->type == EV_PINCH)
+  {
+    // Carry on from wherever the remaining finger has moved the pinch.
+    t->base_dx = t->tot_dx;
+    t->base_dy = t->tot_dy;
+    t->base_tx = t->tot_tx;
+    t->base_ty = t->tot_ty;
+    t->base_sx = t->tot_sx;
+    t->base_sy = t->tot_sy;
+    begin_pinch(t);
+  }
+  else
+  {
+    start_new_tracked(t, current_time, EV_PINCH);
+  }
+}
+
+void GestureDetector::pinch_frame(TrackedEvent *t, unsigned long current_time, TouchContact *c)
+{
+  bool moved;
+
+  moved = follow_contact(&t->cont[0], current_time, &c[t->cont[0].at]);
+  if (t->ncont == 2)
+  {
+    moved |= follow_contact(&t->cont[1], current_time, &c[t->cont[1].at]);
+    t->hold_time = current_time - t->start_time;
+  }
+  if (!moved)
+  {
+    input_stats.still_callbacks++;
+    return;
+  }
+  call_cb(t);
+}
+
+void GestureDetector::pinch_lift(TrackedEvent *t, unsigned long current_time, TouchContact *c)
+{
+  int k;
+
+  if (t->ncont == 1 || (t->cont[0].at < 0 && t->cont[1].at < 0))
+  {
+    t->type |= EV_RELEASED;
+    call_cb(t);
+    end_tracked(t, current_time);
+    return;
+  }
+
+  // We have been pinching, but one finger has been lifted off. The
+  // other carries on moving the pinch from where it is, and another
+  // finger can land to pinch again. If the pinch has no event, the
+  // other finger starts a new drag instead.
+  k = (t->cont[0].at >= 0) ? t->cont[0].at : t->cont[1].at;
+  if (t->active_event >= 0)
+  {
+    t->base_dx = t->tot_dx;
+    t->base_dy = t->tot_dy;
+    t->base_tx = t->tot_tx;
+    t->base_ty = t->tot_ty;
+    t->base_sx = t->tot_sx;
+    t->base_sy = t->tot_sy;
+  }
+  else
+  {
+    start_new_tracked(t, current_time, EV_DRAG);
+  }
+  start_contact(&t->cont[0], current_time, &c[k]);
+  t->cont[0].at = k;
+  t->ncont = 1;
+#if GD_USE_STROKE
+  stroke_begin(&t->stroke, c[k].x, c[k].y);
+#endif
+}
+#endif
+
+// Move a tracked contact to where it is in this frame, after smoothing out
+// any jitter with the filter. Returns true if it has moved since the last frame.
+bool GestureDetector::follow_contact(TrackedContact *tc, unsigned long current_time, TouchContact *c)
+{
+  int x = c->x;
+  int y = c->y;
+  int last_x = tc->init_x + tc->dx;
+  int last_y = tc->init_y + tc->dy;
+
+  if (filter_cutoff > 0)
+  {
+    // One Euro filter: a low pass filter whose cutoff frequency goes up with
+    // the speed, so it smooths out jitter when the contact is (nearly) still
+    // without lagging behind when it moves quickly. Times are in seconds.
+    float dt = (current_time - tc->filter_time) * 0.001f;
+    float vx, vy, a, cutoff;
+
+    if (dt > 0)
+    {
+      a = filter_alpha(FILTER_D_CUTOFF, dt);
+      vx = (x - tc->fx) / dt;
+      vy = (y - tc->fy) / dt;
+      tc->fvx += a * (vx - tc->fvx);
+      tc->fvy += a * (vy - tc->fvy);
+      cutoff = filter_cutoff + filter_beta * sqrt(tc->fvx * tc->fvx + tc->fvy * tc->fvy);
+      a = filter_alpha(cutoff, dt);
+      tc->fx += a * (x - tc->fx);
+      tc->fy += a * (y - tc->fy);
+      tc->filter_time = current_time;
+    }
+    x = lroundf(tc->fx);
+    y = lroundf(tc->fy);
+    if (x == last_x && y == last_y && (c->x != last_x || c->y != last_y))
+      input_stats.jitter_samples++;
+  }
+
+  move_contact(tc, current_time, x, y);
+  return x != last_x || y != last_y;
+}
+
+// The smoothing factor of a low pass filter with the given cutoff (Hz)
+// for a sample dt seconds after the last.
+float GestureDetector::filter_alpha(float cutoff, float dt)
+{
+  float tau = 1.0f / (2 * PI * cutoff);
+
+  return 1.0f / (1.0f + tau / dt);
+}
+
+// Whether a contact has moved further than the touch slop from where it started.
+bool GestureDetector::past_slop(TrackedContact *tc)
+{
+  return (long)tc->dx * tc->dx + (long)tc->dy * tc->dy > (long)touch_slop * touch_slop;
+}
+
+void GestureDetector::setFilter(float min_cutoff, float beta)
+{
+  filter_cutoff = min_cutoff;
+  filter_beta = beta;
+}
+
+void GestureDetector::getInputStats(InputStats *stats)
+{
+  *stats = input_stats;
+}
+
+void GestureDetector::resetInputStats(void)
+{
+  memset(&input_stats, 0, sizeof(input_stats));
+}
+
+#if GD_INSTRUMENT
+// A snapshot of the stats. The callback phase is only put in when callbacks are
+// made from poll(); in queued mode it belongs to dispatch()'s thread.
+void GestureDetector::getStats(GestureStats *snap)
+{
+  *snap = stats;
+  if (!queued)
+    snap->phase[PH_CALLBACK] = cb_stats;
+}
+
+void GestureDetector::resetStats(void)
+{
+  memset(&stats, 0, sizeof(stats));
+  if (!queued)
+    resetCallbackStats();
+}
+
+// Add a time to a phase's totals and histogram.
+void GestureDetector::record_phase(int phase, unsigned long time)
+{
+  PhaseStats *ps = (phase == PH_CALLBACK) ? &cb_stats : &stats.phase[phase];
+  int b = (time == 0) ? 0 : 32 - __builtin_clz(time);
+
+  if (b >= GD_HIST_BUCKETS)
+    b = GD_HIST_BUCKETS - 1;
+  ps->hist[b]++;
+  ps->count++;
+  ps->total += time;
+  if (time > ps->max)
+    ps->max = time;
+}
+
+// Print the stats: a line per phase that has run, giving its count, mean and
+// maximum times and its histogram (up to the last non-empty bucket), then the
+// counters. For example:
+//    frame n=1200 mean=41 max=310 hist: 0 0 3 17 402 611 150 14 3
+//    polls=1210 frames=1200 hit_tests=96 callbacks: 0 44 402 0 118
+void GestureDetector::dumpStats(Print *out)
+{
+  static const char *names[PH_COUNT] = { "poll", "read", "transform", "frame", "hit_test", "pinch", "stroke", "callback" };
+  GestureStats snap;
+
+  getStats(&snap);
+  for (int p = 0; p < PH_COUNT; p++)
+  {
+    PhaseStats *ps = &snap.phase[p];
+    int last;
+
+    if (ps->count == 0)
+      continue;
+    for (last = GD_HIST_BUCKETS - 1; last > 0 && ps->hist[last] == 0; last--)
+      ;
+    out->print(names[p]);
+    out->print(" n=");
+    out->print(ps->count);
+    out->print(" mean=");
+    out->print(ps->total / ps->count);
+    out->print(" max=");
+    out->print(ps->max);
+    out->print(" hist:");
+    for (int b = 0; b <= last; b++)
+    {
+      out->print(" ");
+      out->print(ps->hist[b]);
+    }
+    out->println();
+  }
+  out->print("polls=");
+  out->print(snap.polls);
+  out->print(" frames=");
+  out->print(snap.frames);
+  out->print(" hit_tests=");
+  out->print(snap.hit_tests);
+  out->print(" callbacks:");
+  for (int e = 0; e <= EV_STROKE; e++)
+  {
+    out->print(" ");
+    out->print(snap.callbacks[e]);
+  }
+  out->println();
 }
+#endif
 
-// Reject any drags/wipes that don't meet the constraints.
-// TODO a version for pinches.
-bool GestureDetector::check_constraints(RegEvent *event, int dx, int dy)
+// Process one frame of contacts, already in screen coordinates. Palms are left out,
+// and if the app has recognisers of its own, they bid for contacts as they land
+// (see addRecognizer). Each recogniser gets the contacts it has; the built-in
+// gestures get the rest.
+void GestureDetector::processFrame(unsigned long current_time, uint8_t contacts, TouchContact *c)
 {
-  if (abs(dx) != 0 && abs(dy/dx) > event->angle_tol)
+  TouchContact kept[MAX_CONTACTS], mine[MAX_CONTACTS], rest[MAX_CONTACTS];
+  bool landed[MAX_CONTACTS];
+  int owner[MAX_CONTACTS];
+  int k, n, r;
+  bool any = false;
+  TIME_START(start);
+
+  COUNT(frames);
+  if (contacts > MAX_CONTACTS)
+    contacts = MAX_CONTACTS;
+
+  // Release any gestures whose layers have been suspended since the last frame.
+  for (TrackedEvent *t = tracks; t < tracks + MAX_TRACKS; t++)
   {
-    // Vertical (or nearly so). Reject if we only want horizontal.
-    if (event->constraint == CO_HORIZ)
-      return false;
+    if (t->type != EV_NONE && !t->suspended)
+      release_suspended(t);
   }
-  else if (abs(dy) != 0 && abs(dx/dy) > event->angle_tol)
+
+  // Leave out any contacts big enough to be a palm resting on the screen.
+  // A gesture whose contact turns into a palm is released.
+  if (palm_area > 0)
   {
-    // Horizontal (or nearly so). Reject if we only want vertical.
-    if (event->constraint == CO_VERT)
-      return false;
+    for (k = n = 0; k < contacts; k++)
+    {
+      if (c[k].area > palm_area)
+        input_stats.palm_contacts++;
+      else
+        kept[n++] = c[k];
+    }
+    c = kept;
+    contacts = n;
   }
-  else
+
+  // Which contacts have landed since the last frame?
+  for (k = 0; k < contacts; k++)
   {
-    // It's in between vertical and horizontal. Only accept if CO_NONE.
-    if (event->constraint != CO_NONE)
-      return false;
+    for (n = 0; n < seen_contacts && c[k].id != seen_ids[n]; n++)
+      ;
+    landed[k] = (n == seen_contacts);
+    any |= landed[k];
   }
-  return true;
-}
+  for (k = 0; k < contacts; k++)
+    seen_ids[k] = c[k].id;
+  seen_contacts = contacts;
 
-// Adjust the dx/dy of a drag or pinch to constraints and angle_tol.
-// This version cannot reject an event but only modify it.
-// Return the constraint that was either enforced or impled by the angle_tol.
-Constraint GestureDetector::enforce_constraints(RegEvent *event, int dx, int dy, int *new_dx, int *new_dy)
-{
-  *new_dx = dx;
-  *new_dy = dy;
-  if (event->constraint == CO_VERT)         // TODO snap sx/sy here for pinches likewise
+  if (nrecognizers == 0)
   {
-    *new_dx = 0;
-    return CO_VERT;
+    track_frame(current_time, contacts, c);
+    TIME_END(PH_FRAME, start);
+    return;
   }
-  else if (event->constraint == CO_HORIZ)
+  if (any)
+    take_bids(current_time, contacts, c, landed);
+
+  // Give each recogniser the contacts it still has. When they have all
+  // lifted, it gets a frame of none, and a removed one's slot is freed.
+  for (k = 0; k < contacts; k++)
+    owner[k] = contact_owner(c[k].id);
+  for (r = 0; r < MAX_RECOGNIZERS; r++)
   {
-    *new_dy = 0;
-    return CO_HORIZ;
+    Recognizer *rec = &recognizers[r];
+
+    if (rec->nids == 0)
+      continue;
+    for (k = n = 0; k < contacts; k++)
+    {
+      if (owner[k] == r)
+        mine[n++] = c[k];
+    }
+    for (k = 0; k < n; k++)
+      rec->ids[k] = mine[k].id;
+    rec->nids = n;
+    if (rec->frame != NULL)
+      rec->frame(rec->param, current_time, n, mine);
+    if (n == 0 && rec->bid == NULL)
+      nrecognizers--;
   }
-  else if (abs(dx) == 0 || abs(dy/dx) > event->angle_tol)
+
+  for (k = n = 0; k < contacts; k++)
   {
-    *new_dx = 0;
-    return CO_VERT;
+    if (owner[k] < 0)
+      rest[n++] = c[k];
   }
-  else if (abs(dy) == 0 || abs(dx/dy) > event->angle_tol)
+  track_frame(current_time, n, rest);
+  TIME_END(PH_FRAME, start);
+}
+
+// The recogniser that has a contact, or -1 if it's the built-in gestures'.
+int GestureDetector::contact_owner(uint8_t id)
+{
+  for (int r = 0; r < MAX_RECOGNIZERS; r++)
   {
-    *new_dy = 0;
-    return CO_HORIZ;
+    for (int n = 0; n < recognizers[r].nids; n++)
+    {
+      if (recognizers[r].ids[n] == id)
+        return r;
+    }
   }
-
-  return CO_NONE;
+  return -1;
 }
 
-
-// Call any valid callback function for the tracked event. Apply any constraints
-// and check if initial point(s) are inside any given regions for the registered
-// callback.
-void GestureDetector::call_cb(void)
+// Contacts have landed. Take bids for them, along with any they could go with:
+// those of taps still being held, and those the app's recognisers have (but
+// not one that has been removed). Drags, pinches and the like carry on. The
+// built-in gestures bid the least anyone can to have them; ties go to a
+// recogniser that has some of them already.
+void GestureDetector::take_bids(unsigned long current_time, uint8_t contacts, TouchContact *c, bool *landed)
 {
-  int i, dx, dy, dx0, dy0, dx1, dy1;
-  float sx, sy;
-  EventType released = track.type & EV_RELEASED;  // this is why they are const ints, not an enum
-  EventType ev = track.type & ~EV_RELEASED;
+  TouchContact group[MAX_CONTACTS];
+  TrackedEvent *taps[MAX_CONTACTS];
+  TrackedEvent *t;
+  int k, n, r, bid, ntaps = 0, best = -1, best_bid = BUILTIN_BID;
 
-  // Switch on the underlying event type
-  switch (ev)
+  for (k = n = 0; k < contacts; k++)
   {
-  case EV_TAP:
-    // Look for a matching event if we haven't already got one
-    if (track.active_event < 0)
+    r = contact_owner(c[k].id);
+    if (r >= 0 && recognizers[r].bid == NULL)
+      continue;
+    if (!landed[k] && r < 0)
     {
-      for (i = MAX_EVENTS - 1; i >= 0; i--)
+      for (t = tracks; t < tracks + MAX_TRACKS; t++)
       {
-        if (!in_region(&events[i], track.cont[0].init_x, track.cont[0].init_y))
-          continue;
-        if (events[i].type == EV_TAP)
-        {
-          track.active_event = i;
+        if (t->type == EV_TAP && t->ncont == 1 && t->cont[0].id == c[k].id)
           break;
-        }
       }
+      if (t == tracks + MAX_TRACKS)
+        continue;
+      taps[ntaps++] = t;
     }
+    group[n++] = c[k];
+  }
 
-    if (track.active_event < 0)
-      return;   // nothing to do here
-
-#if 0
-    Serial.print("Tap ");
-    if (released)
-      Serial.print("(Rel) ");
-    Serial.print(track.active_event);
-    Serial.print(" ");
-    Serial.print(track.cont[0].init_x + track.cont[0].dx);
-    Serial.print(" ");
-    Serial.println(track.cont[0].init_y + track.cont[0].dy);
-#endif
-
-    i = track.active_event;
-
-    if (track.hold_time >= LONG_PRESS_TIME)
+  for (r = 0; r < MAX_RECOGNIZERS; r++)
+  {
+    if (recognizers[r].bid == NULL)
+      continue;
+    bid = recognizers[r].bid(recognizers[r].param, current_time, n, group);
+    if (bid > best_bid)
     {
-      events[i].tapCallback(EV_TAP | EV_LONG_PRESS | released, i, events[i].param, track.cont[0].init_x, track.cont[0].init_y);
-      return;
+      best = r;
+      best_bid = bid;
     }
-    else
+    else if (bid == best_bid && best >= 0)
     {
-      events[i].tapCallback(EV_TAP | released, i, events[i].param, track.cont[0].init_x, track.cont[0].init_y);
-      return;
+      for (k = 0; k < n && contact_owner(group[k].id) != r; k++)
+        ;
+      if (k < n)
+        best = r;
     }
-    break;
+  }
 
-  case EV_DRAG:
-  case EV_SWIPE:
-    if (track.active_event < 0)
+  // If the built-in gestures win, they just get the contacts that landed, and
+  // the rest stay where they are. Otherwise whoever else had any of them loses
+  // them: a recogniser is cancelled, and a tap is dropped.
+  if (best < 0)
+    return;
+  for (k = 0; k < n; k++)
+  {
+    r = contact_owner(group[k].id);
+    if (r < 0 || r == best)
+      continue;
+    if (recognizers[r].cancel != NULL)
+      recognizers[r].cancel(recognizers[r].param, current_time);
+    recognizers[r].nids = 0;
+  }
+  for (k = 0; k < ntaps; k++)
+    drop_tap(taps[k], current_time);
+  for (k = 0; k < n; k++)
+    recognizers[best].ids[k] = group[k].id;
+  recognizers[best].nids = n;
+}
+
+// The built-in gestures' part of processing a frame. Each gesture in progress
+// follows its own contacts (by their trackId, or failing that by distance), so taps,
+// drags and pinches in different regions go on independently. A new contact starts
+// a new gesture, unless it makes a pinch with a single contact already down; both
+// must be in a pinch region for that.
+void GestureDetector::track_frame(unsigned long current_time, uint8_t contacts, TouchContact *c)
+{
+  bool matched[MAX_CONTACTS] = { false };
+  TrackedEvent *t, *fresh[MAX_CONTACTS];
+  int k, n, nfresh = 0;
+
+  // Find where each tracked contact is in this frame, if it's still down,
+  // by its trackId.
+  for (t = tracks; t < tracks + MAX_TRACKS; t++)
+  {
+    if (t->type == EV_NONE)
+      continue;
+    for (n = 0; n < t->ncont; n++)
     {
-      for (i = MAX_EVENTS - 1; i >= 0; i--)
+      t->cont[n].at = -1;
+      for (k = 0; k < contacts; k++)
       {
-        if (!in_region(&events[i], track.cont[0].init_x, track.cont[0].init_y))
-          continue;
-        if (!check_constraints(&events[i], track.cont[0].dx, track.cont[0].dy))
-          continue;
-        if (events[i].type == ev)
+        if (!matched[k] && c[k].id == t->cont[n].id)
         {
-          track.active_event = i;
+          t->cont[n].at = k;
+          matched[k] = true;
           break;
         }
       }
     }
+  }
 
-    if (track.active_event < 0)
-      return;   // nothing to do here
-
-#if 0
-    if (ev == EV_DRAG)
-      Serial.print("Drag ");
-    else
-      Serial.print("Swipe ");
-    if (released)
-      Serial.print("(Rel) ");
-    Serial.print(track.active_event);
-    Serial.print(" ");
-    Serial.print(track.cont[0].init_x + track.cont[0].dx);
-    Serial.print(" ");
-    Serial.println(track.cont[0].init_y + track.cont[0].dy);
-#endif
-
-    i = track.active_event;
-    ASSERT(events[i].type == EV_DRAG || events[i].type == EV_SWIPE);
-    enforce_constraints(&events[i], track.cont[0].dx, track.cont[0].dy, &dx, &dy);
-    events[i].dragCallback(ev | released, i, events[i].param, track.cont[0].init_x, track.cont[0].init_y, dx, dy);
-    break;
-
-  case EV_PINCH:
-    if (track.active_event < 0)
+  // If the controller has given a contact a new trackId, it will look as if one
+  // contact has lifted and another landed. Match any that are close enough.
+  for (t = tracks; t < tracks + MAX_TRACKS; t++)
+  {
+    if (t->type == EV_NONE)
+      continue;
+    for (n = 0; n < t->ncont; n++)
     {
-      for (i = MAX_EVENTS - 1; i >= 0; i--)
-      {
-        // This event has two contacts, which both must be in-region
-        // and pass any H/V constraints based on their initial positions.
-        if (!in_region(&events[i], track.cont[0].init_x, track.cont[0].init_y))
-          continue;
-        if (!in_region(&events[i], track.cont[1].init_x, track.cont[1].init_y))
-          continue;
+      TrackedContact *tc = &t->cont[n];
+      long best = (long)MATCH_DISTANCE * MATCH_DISTANCE + 1;
 
-        if
-        (
-          !check_constraints
-          (
-            &events[i],
-            track.cont[0].init_x - track.cont[1].init_x,
-            track.cont[0].init_y - track.cont[1].init_y
-          )
-        )
-          continue;
+      if (tc->at >= 0)
+        continue;
+      for (k = 0; k < contacts; k++)
+      {
+        long ex = c[k].x - (tc->init_x + tc->dx);
+        long ey = c[k].y - (tc->init_y + tc->dy);
 
-        if (events[i].type == EV_PINCH)
+        if (!matched[k] && ex * ex + ey * ey < best)
         {
-          int dummy_dx, dummy_dy;
-
-          track.active_event = i;
-
-          // We can set the working constraint up once here, as it only
-          // depends on the initial contact points.
-          track.working_co =
-            enforce_constraints
-            (
-              &events[i],
-              track.cont[0].init_x - track.cont[1].init_x,
-              track.cont[0].init_y - track.cont[1].init_y,
-              &dummy_dx,
-              &dummy_dy
-            );
-          break;
+          best = ex * ex + ey * ey;
+          tc->at = k;
         }
       }
+      if (tc->at >= 0)
+      {
+        matched[tc->at] = true;
+        tc->id = c[tc->at].id;
+      }
     }
-
-    if (track.active_event < 0)
-      return;   // nothing to do here
-
-#if 0
-    Serial.print("Pinch ");
-    if (released)
-      Serial.print("(Rel) ");
-    Serial.print(track.active_event);
-    Serial.print(" ");
-    Serial.print(track.cont[0].init_x + track.cont[0].dx);
-    Serial.print(" ");
-    Serial.print(track.cont[0].init_y + track.cont[0].dy);
-    Serial.print(" ");
-    Serial.print(track.cont[1].init_x + track.cont[1].dx);
-    Serial.print(" ");
-    Serial.println(track.cont[1].init_y + track.cont[1].dy);
-#endif
-
-    i = track.active_event;
-    ASSERT(events[i].type == EV_PINCH);
-
-    // Handle this differently depending on whether this pinch is rotatable or not.
-    // Some local variables/line shorteners
-    int init_x0 = track.cont[0].init_x;
-    int init_y0 = track.cont[0].init_y;
-    int init_x1 = track.cont[1].init_x;
-    int init_y1 = track.cont[1].init_y;
-    int x0 = track.cont[0].init_x + track.cont[0].dx;
-    int y0 = track.cont[0].init_y + track.cont[0].dy;
-    int x1 = track.cont[1].init_x + track.cont[1].dx;
-    int y1 = track.cont[1].init_y + track.cont[1].dy;
-
-    if (events[i].rotatable)
-    {
-      // Measure the (single) scale factor.
-      float len0 = length(init_x0, init_x1, init_y0, init_y1);
-      float len1 = length(x0, x1, y0, y1);
-      float scale = len1 / len0;
-
-      // Measure the rotation by comparing the lines between the endpoints,
-      // giving the cos and sin of the rotation angle.
-      float cosa = dot(init_x1 - init_x0, x1 - x0, init_y1 - init_y0, y1 - y0);
-      cosa = (cosa / len1) / len0;
-
-      float sina = perp(init_x1 - init_x0, x1 - x0, init_y1 - init_y0, y1 - y0);
-      sina = (sina / len1) / len0;
-
-#if 0
-        Serial.print("Scale ");
-        Serial.print(scale);
-        Serial.print(" Cosa/sina ");
-        Serial.print(cosa);
-        Serial.print(" ");
-        Serial.println(sina);
-#endif
-
-      // Calculate the translation components
-      if (scale < MIN_SCALE)
-        scale = MIN_SCALE;
-      sx = cosa * scale;
-      sy = sina * scale;
-      dx = x0 - (sx * init_x0 - sy * init_y0);
-      dy = y0 - (sy * init_x0 + sx * init_y0);
-#if 0
-      Serial.print("dx/dy ");
-      Serial.print(" ");
-      Serial.print(dx);
-      Serial.print(" ");
-      Serial.println(dy);
-#endif
-    }
-    else
-    {
-      // Simpler case with two scales and no rotation. Solve 4 simultaneous
-      // equations for 4 coefficients.
-      if (track.working_co == CO_VERT)
-        sx = 1.0f;
-      else
-        sx = (float)(x0 - x1) / ((init_x0 - init_x1));
-
-      if (track.working_co == CO_HORIZ)
-        sy = 1.0f;
-      else
-        sy = (float)(y0 - y1) / ((init_y0 - init_y1));
-
-#if 0
-      Serial.print("Scales ");
-      Serial.print(sx);
-      Serial.print(" ");
-      Serial.println(sy);
-#endif
-
-      // Calculate the translation components
-      if (sx < MIN_SCALE)
-        sx = MIN_SCALE;
-      if (sy < MIN_SCALE)
-        sy = MIN_SCALE;
-      dx = x0 - sx * init_x0;
-      dy = y0 - sy * init_y0;
-    }
-    events[i].pinchCallback(EV_PINCH | released, i, events[i].param, dx, dy, sx, sy);
-    break;
   }
-}
-
-// Start a new tracked event. zero out timer counter and active
-// event index, so the next call to call_cb() finds the right event.
-void GestureDetector::start_new_tracked(unsigned long current_time, EventType ev)
-{
-  track.start_time = current_time;
-  track.hold_time = 0;
-  track.active_event = -1;
-  track.type = ev;
-}
-
-
-// Poll for some activity.
-void GestureDetector::poll()
-{
-  uint8_t contacts;
-  GDTpoint_t points[5];
-  unsigned long current_time;
-  int x[5], y[5], t;
+#if GD_USE_DRAG
+  // Keep any inertia going while nothing new is touching the screen.
+  // A new touch stops it where it is.
+  bool landed = false;
 
-  // If it hasn't been 30ms since last time, just return.
-  current_time = millis();
-  if (current_time < last_polled + SCAN_TIME)
-    return;
-  last_polled = current_time;
-
-  contacts = getTouchPoints(points);
-
-#if 0
-    // Debugging code to print out the active contacts.
-  if (contacts > 0)
+  for (k = 0; k < contacts; k++)
   {
-    Serial.print("Contacts: ");
-    Serial.println(contacts);
-
-    for (uint8_t i = 0; i < contacts; i++)
-    {
-      Serial.print(i);
-      Serial.print(" ");
-      Serial.print(points[i].trackId);
-      Serial.print(" ");
-      Serial.print(points[i].x);
-      Serial.print(" ");
-      Serial.print(points[i].y);
-      Serial.print(" ");
-      Serial.println(points[i].area);
-    }
+    if (!matched[k])
+      landed = true;
+  }
+  for (t = tracks; t < tracks + MAX_TRACKS; t++)
+  {
+    if (t->fling.active)
+      step_fling(t, current_time, landed);
   }
 #endif
 
-  // Handle rotation on the points coming back from the touch screen.
-  for (uint8_t i = 0; i < contacts; i++)
+  // Follow the gestures in progress, releasing any whose contacts have lifted.
+  for (t = tracks; t < tracks + MAX_TRACKS; t++)
   {
-    switch (rotation)
+    const Builtin *g = &builtins[t->type];
+    bool lifted = false;
+
+    if (t->type == EV_NONE)
+      continue;
+    for (n = 0; n < t->ncont; n++)
     {
-    case 0:
-      x[i] = points[i].x;
-      y[i] = points[i].y;
-      break;
-    case 1:
-      x[i] = points[i].y;
-      y[i] = WIDTH - 1 - points[i].x;
-      break;
-    case 2:
-      x[i] = WIDTH - 1 - points[i].x;
-      y[i] = HEIGHT - 1 - points[i].y;
-      break;
-    case 3:
-      x[i] = HEIGHT - 1 - points[i].y;
-      y[i] = points[i].x;
-      break;
+      if (t->cont[n].at < 0)
+        lifted = true;
     }
+    if (lifted && g->lift == NULL)
+      end_tracked(t, current_time);   // nothing left to call back
+    else if (lifted)
+      (this->*g->lift)(t, current_time, c);
+    else if (g->frame != NULL)
+      (this->*g->frame)(t, current_time, c);
   }
 
-  // Deal with the combinations of current contacts and previous contacts.
-  switch (contacts)
+  // Start gestures for the new contacts. The built-in gestures bid for each, on
+  // its own or with a gesture of one contact already down (including one new
+  // in this frame), and the highest bid starts on it. Those started on their
+  // own are called back once all the new contacts have been paired up. If all
+  // the slots are in use, the contact is ignored.
+  for (k = 0; k < contacts; k++)
   {
-  case 0:
-    // No contacts. Call the relevant callback with the released flag set.
-    if (track.type == EV_TAP && (track.cont[0].dx != 0 || track.cont[0].dy != 0))
-      start_new_tracked(current_time, EV_SWIPE);
-    track.type |= EV_RELEASED;
-    call_cb();
-    start_new_tracked(current_time, EV_NONE);
-    break;
-
-  case 1:
-    // One contact. See what we have been doing previously.
-    switch (track.type)
-    {
-    case EV_NONE:
-      // A new contact. Send to tap. It could become a long press or a drag later.
-      start_new_tracked(current_time, EV_TAP);
-      track.cont[0].init_x = x[0];
-      track.cont[0].init_y = y[0];
-      track.cont[0].dx = track.cont[0].dy = 0;
-      track.cont[0].indx = 0;
-      call_cb();
-      break;
+    const Builtin *best = NULL;
+    TrackedEvent *with = NULL;
+    int bid, best_bid = 0;
 
-    case EV_TAP:
-    case EV_DRAG:
-      // Still holding a tap, or perheps dragging. Cope with the case where
-      // the finger moves.
-      track.cont[0].dx = x[0] - track.cont[0].init_x;
-      track.cont[0].dy = y[0] - track.cont[0].init_y;
-      track.hold_time = current_time - track.start_time;
-      if (track.cont[0].dx != 0 || track.cont[0].dy != 0)
+    if (matched[k])
+      continue;
+    for (const Builtin *g = builtins; g < builtins + EV_STROKE + 1; g++)
+    {
+      if (g->bid == NULL)
+        continue;
+      for (t = tracks; t < tracks + MAX_TRACKS; t++)
       {
-        // There is movement. This contact is promoted to a drag.
-        // If the movement is fast (it's released in <= SWIPE_TIME ms)
-        // then it becomes a swipe. Call its callback. Do not release
-        // the tap, as it isn't really a tap anyway. Update the start time
-        // for a new speed calculation now that drag has begun.
+        if (t->type == EV_NONE || t->ncont != 1)
+          continue;
+        bid = (this->*g->bid)(t, c, k);
+        if (bid > best_bid)
         {
-          if (track.type == EV_TAP && track.hold_time > SWIPE_TIME)
-            start_new_tracked(current_time, EV_DRAG);
-          call_cb();
+          best = g;
+          best_bid = bid;
+          with = t;
         }
       }
-      break;
-
-    case EV_PINCH:
-      // We have been pinching, but one finger has been lifted off.
-      // Since we don't know which one, we can't continue a drag from its
-      // last position; release the pinch and start a new drag from here.
-      track.type |= EV_RELEASED;
-      call_cb();
-
-      start_new_tracked(current_time, EV_DRAG);
-      track.cont[0].init_x = x[0];
-      track.cont[0].init_y = y[0];
-      track.cont[0].dx = track.cont[0].dy = 0;
-      track.cont[0].indx = 0;
-      break;
+      bid = (this->*g->bid)(NULL, c, k);
+      if (bid > best_bid)
+      {
+        best = g;
+        best_bid = bid;
+        with = NULL;
+      }
     }
-    break;
 
-  case 2:
-    // There are two contacts. We are either starting or continuing a pinch.
-    if (track.type != EV_PINCH)
-    {
-      // Start a new pinch.
-      start_new_tracked(current_time, EV_PINCH);
-      track.cont[0].init_x = x[0];
-      track.cont[0].init_y = y[0];
-      track.cont[0].dx = track.cont[0].dy = 0;
-      track.cont[0].indx = 0;
-      track.cont[1].init_x = x[1];
-      track.cont[1].init_y = y[1];
-      track.cont[1].dx = track.cont[1].dy = 0;
-      track.cont[1].indx = 1;
+    if (best == NULL)
+      continue;
+    if (with != NULL)
+    {
+      (this->*best->land)(with, current_time, c, k);
     }
-    else
+    else if ((t = free_track()) != NULL)
     {
-      track.cont[0].dx = x[0] - track.cont[0].init_x;
-      track.cont[0].dy = y[0] - track.cont[0].init_y;
-      track.cont[1].dx = x[1] - track.cont[1].init_x;
-      track.cont[1].dy = y[1] - track.cont[1].init_y;
-      track.hold_time = current_time - track.start_time;
-      call_cb();
+      (this->*best->land)(t, current_time, c, k);
+      fresh[nfresh++] = t;
     }
-    break;
   }
+
+  for (n = 0; n < nfresh; n++)
+  {
+    if (fresh[n]->ncont == 1)
+      call_cb(fresh[n]);
+  }
+#if GD_USE_TAP
+  if (taps_waiting != 0)
+    confirm_taps(current_time);
+#endif
+}
+
+// Add a recogniser in the first free slot.
+int GestureDetector::addRecognizer(RecognizerBid bid, RecognizerFrame frame, RecognizerCancel cancel, void *param)
+{
+  if (bid == NULL || frame == NULL)
+    return -1;
+  for (int r = 0; r < MAX_RECOGNIZERS; r++)
+  {
+    if (recognizers[r].bid != NULL || recognizers[r].nids > 0)
+      continue;
+    recognizers[r].bid = bid;
+    recognizers[r].frame = frame;
+    recognizers[r].cancel = cancel;
+    recognizers[r].param = param;
+    nrecognizers++;
+    return r;
+  }
+  return -1;
+}
+
+// Remove a recogniser. If it has contacts, it is cancelled, and its slot is
+// kept (with nothing to call) until they lift, so nothing else takes them up.
+void GestureDetector::removeRecognizer(int n, unsigned long time)
+{
+  if (n < 0 || n >= MAX_RECOGNIZERS || recognizers[n].bid == NULL)
+    return;
+  if (recognizers[n].nids > 0 && recognizers[n].cancel != NULL)
+    recognizers[n].cancel(recognizers[n].param, time);
+  recognizers[n].bid = NULL;
+  recognizers[n].frame = NULL;
+  if (recognizers[n].nids == 0)
+    nrecognizers--;
 }
 
 // Register callbacks for the various kinds of gestures. The various flavours of this call,
@@ -512,25 +2386,261 @@ void GestureDetector::fill_event
   void *param,
   bool rotatable,
   Constraint constraint,
-  int angle_tol
+  int angle_tol,
+  float min_speed,
+  bool inertia
 )
 {
+  int l;
+
   if (indx >= MAX_EVENTS)
     return;   // TODO figure out how to return an error code here
   if (nPts > MAX_POINTS)
     nPts = MAX_POINTS;
 
+  // Take the old region out of the hit map before it is overwritten,
+  // along with any other events that share it.
+  if (use_hit_map)
+  {
+    if (events[indx].type != EV_NONE && events[indx].region != indx)
+      map_event(indx, false);
+    map_region(indx, false);
+  }
+
   events[indx].type = ev;
   events[indx].param = param;
   if (nPts != 0)
     memcpy(events[indx].reg, rc, nPts * sizeof(Point));
   events[indx].reg[nPts] = events[indx].reg[0];  // Close polygon for in_polygon test
   events[indx].nPts = nPts;
+  events[indx].region = indx;
+  events[indx].transformed = false;
+  events[indx].xf = Affine();
+  events[indx].node = -1;
+  events[indx].lxmin = events[indx].lxmax = events[indx].reg[0].x;
+  events[indx].lymin = events[indx].lymax = events[indx].reg[0].y;
+  for (int i = 1; i < nPts; i++)
+  {
+    events[indx].lxmin = min(events[indx].lxmin, events[indx].reg[i].x);
+    events[indx].lymin = min(events[indx].lymin, events[indx].reg[i].y);
+    events[indx].lxmax = max(events[indx].lxmax, events[indx].reg[i].x);
+    events[indx].lymax = max(events[indx].lymax, events[indx].reg[i].y);
+  }
+  // A rectangle as made by fill_rect_region (or given in the same order) is
+  // tested as one, which gives the same answers as the polygon test.
+  events[indx].shape = RS_POLYGON;
+  events[indx].radius = 0;
+  if
+  (
+    nPts == 4
+    && rc[0].y == rc[1].y && rc[1].x == rc[2].x && rc[2].y == rc[3].y && rc[3].x == rc[0].x
+    && rc[1].x > rc[0].x && rc[2].y > rc[1].y
+  )
+    events[indx].shape = RS_RECT;
+  events[indx].xmin = events[indx].lxmin;
+  events[indx].ymin = events[indx].lymin;
+  events[indx].xmax = events[indx].lxmax;
+  events[indx].ymax = events[indx].lymax;
+  events[indx].shown = DamageRect(events[indx].xmin, events[indx].ymin, events[indx].xmax, events[indx].ymax);
   events[indx].tapCallback = tapCB;
   events[indx].dragCallback = dragCB;
   events[indx].pinchCallback = pinchCB;
+#if GD_USE_DRAG || GD_USE_SWIPE || GD_USE_PINCH
+  events[indx].affineCallback = NULL;
+  events[indx].cb_moving = false;
+#endif
+  events[indx].confirm_taps = false;
+  events[indx].tap_count = 0;
+  taps_waiting &= ~EVENT_BIT(indx);
+  events[indx].strokeCallback = NULL;
+  events[indx].templates = NULL;
+  events[indx].ntemplates = 0;
   events[indx].constraint = constraint;
   events[indx].angle_tol = angle_tol;
   events[indx].rotatable = rotatable;
+  events[indx].min_speed = min_speed;
+  events[indx].inertia = inertia;
+
+  if (use_hit_map)
+    map_region(indx, true);
+
+  // A new event belongs to the top layer. One registered again (e.g. to move its
+  // region) stays in the layer it was in, so it doesn't come up through a modal
+  // layer above it, or get cancelled when that is popped.
+  for (l = 0; l <= top_layer; l++)
+  {
+    if (layer_events[l] & EVENT_BIT(indx))
+      break;
+  }
+  if (l > top_layer)
+    layer_events[top_layer] |= EVENT_BIT(indx);
+  update_layers();
+}
+
+// Transform a region in place. Only its bounding box is transformed here
+// (to keep the hit map up to date); touches are transformed back to the
+// region as registered when they are tested against it.
+void GestureDetector::transformRegion(int indx, Affine xf)
+{
+  RegEvent *event;
+  Affine prev;
+
+  if (indx >= MAX_EVENTS)
+    return;
+  event = &events[events[indx].region];
+  prev = event->xf;
+  event->xf = xf;
+  if (!place_region(events[indx].region))
+    event->xf = prev;   // degenerate transform; leave the region where it was
+}
+
+// Put a region where its own transform and its node's put it on the screen,
+// keeping the inverse for hit testing and the bounding box for the hit map.
+// Returns false (leaving it where it was) if the whole transform is degenerate.
+bool GestureDetector::place_region(int owner)
+{
+  RegEvent *event = &events[owner];
+  Affine xf = event->xf;
+  Affine inv;
+  DamageRect box;
+
+  if (event->node >= 0)
+    xf = xf.then(nodes[event->node].world);
+  if (!xf.invert(&inv))
+    return false;
+
+  if (use_hit_map)
+    map_region(owner, false);
+
+  event->inv_xf = inv;
+  event->transformed = true;
+  box = xf.apply(DamageRect(event->lxmin, event->lymin, event->lxmax, event->lymax));
+  event->xmin = box.xmin;
+  event->ymin = box.ymin;
+  event->xmax = box.xmax;
+  event->ymax = box.ymax;
+  event->shown = box;
+  reg_gen++;
+
+  if (use_hit_map)
+    map_region(owner, true);
+  return true;
+}
+
+bool GestureDetector::setNode(int node, int parent)
+{
+  if (node < 0 || node >= MAX_NODES || parent < -1 || parent >= MAX_NODES)
+    return false;
+
+  // The node can't go under itself or any of its children.
+  for (int p = parent; p >= 0; p = nodes[p].parent)
+  {
+    if (p == node)
+      return false;
+  }
+  nodes[node].parent = parent;
+  update_node(node);
+  return true;
+}
+
+void GestureDetector::transformNode(int node, Affine xf)
+{
+  Affine inv;
+
+  if (node < 0 || node >= MAX_NODES || !xf.invert(&inv))
+    return;
+  nodes[node].xf = xf;
+  update_node(node);
+}
+
+// Work out a node's transform to the screen, then those of its children, and
+// put the regions attached to it back on the screen.
+void GestureDetector::update_node(int node)
+{
+  Node *n = &nodes[node];
+  EventMask placed = 0;
+  int owner;
+
+  n->world = (n->parent < 0) ? n->xf : n->xf.then(nodes[n->parent].world);
+  for (int i = 0; i < MAX_NODES; i++)
+  {
+    if (nodes[i].parent == node)
+      update_node(i);
+  }
+
+  // A region can be used by several events, so only place it once.
+  for (int i = 0; i < MAX_EVENTS; i++)
+  {
+    if (events[i].type == EV_NONE)
+      continue;
+    owner = events[i].region;
+    if (events[owner].node != node || (placed & EVENT_BIT(owner)))
+      continue;
+    place_region(owner);
+    placed |= EVENT_BIT(owner);
+  }
+}
+
+void GestureDetector::attachRegion(int indx, int node)
+{
+  int owner;
+
+  if (indx >= MAX_EVENTS || events[indx].type == EV_NONE || node < -1 || node >= MAX_NODES)
+    return;
+  owner = events[indx].region;
+  events[owner].node = node;
+  place_region(owner);
+}
+
+void GestureDetector::shareRegion(int indx, int src)
+{
+  if (indx >= MAX_EVENTS || src >= MAX_EVENTS || events[indx].type == EV_NONE)
+    return;
+
+  if (use_hit_map)
+    map_event(indx, false);
+  events[indx].region = events[src].region;
+  reg_gen++;
+  if (use_hit_map)
+    map_event(indx, true);
+}
+
+// Finish registering a stroke, once fill_event has done the rest.
+void GestureDetector::set_stroke(int indx, StrokeCB strokeCB, const StrokeVector *templates, int ntemplates)
+{
+  if (indx >= MAX_EVENTS)
+    return;
+  events[indx].strokeCallback = strokeCB;
+  events[indx].templates = templates;
+  events[indx].ntemplates = ntemplates;
+}
+
+void GestureDetector::setRegionShape(int indx, RegionShape shape, int radius)
+{
+  RegEvent *event;
+
+  if (indx >= MAX_EVENTS || events[indx].type == EV_NONE)
+    return;
+  event = &events[events[indx].region];
+  if (event->nPts == 0)
+    return;   // the whole screen has no shape
+
+  // The corners can't take up more than the rectangle.
+  radius = min(radius, min(event->lxmax - event->lxmin, event->lymax - event->lymin) / 2);
+  event->shape = shape;
+  event->radius = max(radius, 0);
+  reg_gen++;
+}
+
+void GestureDetector::cancelEvent(int indx)
+{
+  taps_waiting &= ~EVENT_BIT(indx);
+  if (use_hit_map && events[indx].type != EV_NONE)
+    map_event(indx, false);
+  events[indx].type = EV_NONE;
+
+  for (int l = 0; l <= top_layer; l++)
+    layer_events[l] &= ~EVENT_BIT(indx);
+  update_layers();
 }
 
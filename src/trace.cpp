@@ -0,0 +1,181 @@
+#include "Arduino.h"
+#include "GestureDetector.h"
+#include "GestureTrace.h"
+
+// Writing and replaying touch traces. The format is described in GestureTrace.h.
+
+static void put16(uint8_t *p, uint16_t v)
+{
+  p[0] = v & 0xFF;
+  p[1] = v >> 8;
+}
+
+static void put32(uint8_t *p, uint32_t v)
+{
+  put16(p, v & 0xFFFF);
+  put16(p + 2, v >> 16);
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+  return p[0] | (p[1] << 8);
+}
+
+static uint32_t get32(const uint8_t *p)
+{
+  return get16(p) | ((uint32_t)get16(p + 2) << 16);
+}
+
+// Write some bytes to the buffer or sink. Once anything fails to be
+// written, nothing more is, so a trace is never left with a hole in it.
+void TraceWriter::put(const uint8_t *data, size_t n)
+{
+  if (failed)
+    return;
+
+  if (sink != NULL)
+  {
+    if (sink(sink_ctx, data, n) != n)
+      failed = true;
+  }
+  else if (written + n > size)
+  {
+    failed = true;
+  }
+  else
+  {
+    memcpy(buf + written, data, n);
+  }
+  if (!failed)
+    written += n;
+}
+
+void TraceWriter::frame(unsigned long time, uint8_t contacts, TouchContact *c)
+{
+  uint8_t rec[3 + 7 * MAX_CONTACTS];
+  unsigned long dt;
+
+  if (!started)
+  {
+    memcpy(rec, "GDTR", 4);
+    put16(rec + 4, TRACE_VERSION);
+    put16(rec + 6, WIDTH);
+    put16(rec + 8, HEIGHT);
+    put16(rec + 10, 0);
+    put32(rec + 12, time);
+    put(rec, TRACE_HEADER_SIZE);
+    started = true;
+    last_time = time;
+  }
+
+  // Long gaps are made up with frames that only advance the time.
+  dt = time - last_time;
+  while (dt > 0xFFFF)
+  {
+    put16(rec, 0xFFFF);
+    rec[2] = TRACE_SKIP;
+    put(rec, 3);
+    dt -= 0xFFFF;
+  }
+  last_time = time;
+
+  if (contacts > MAX_CONTACTS)
+    contacts = MAX_CONTACTS;
+  put16(rec, dt);
+  rec[2] = contacts;
+  for (int i = 0; i < contacts; i++)
+  {
+    uint8_t *p = rec + 3 + 7 * i;
+
+    p[0] = c[i].id;
+    put16(p + 1, c[i].area);
+    put16(p + 3, (uint16_t)(int16_t)c[i].x);
+    put16(p + 5, (uint16_t)(int16_t)c[i].y);
+  }
+  put(rec, 3 + 7 * contacts);
+}
+
+bool TraceReader::begin(void)
+{
+  pos = 0;
+  if (len < TRACE_HEADER_SIZE || memcmp(data, "GDTR", 4) != 0)
+    return false;
+  if (get16(data + 4) != TRACE_VERSION)
+    return false;
+
+  // Contacts are in screen coordinates, so a trace from another screen
+  // would land in the wrong places.
+  if (get16(data + 6) != WIDTH || get16(data + 8) != HEIGHT)
+    return false;
+  time = get32(data + 12);
+  pos = TRACE_HEADER_SIZE;
+  return true;
+}
+
+bool TraceReader::next(unsigned long *t, uint8_t *contacts, TouchContact *c)
+{
+  while (pos + 3 <= len)
+  {
+    const uint8_t *p = data + pos;
+    uint8_t n = p[2];
+
+    time += get16(p);
+    if (n == TRACE_SKIP)
+    {
+      pos += 3;
+      continue;
+    }
+    if (n > MAX_CONTACTS || pos + 3 + 7 * n > len)
+      return false;   // corrupt or truncated
+
+    p += 3;
+    for (int i = 0; i < n; i++, p += 7)
+    {
+      c[i].id = p[0];
+      c[i].area = get16(p + 1);
+      c[i].x = (int16_t)get16(p + 3);
+      c[i].y = (int16_t)get16(p + 5);
+    }
+    pos += 3 + 7 * n;
+    *t = time;
+    *contacts = n;
+    return true;
+  }
+  return false;
+}
+
+long replayTrace(GestureDetector *detector, TraceReader *reader)
+{
+  unsigned long time;
+  uint8_t contacts;
+  TouchContact c[MAX_CONTACTS];
+  long frames = 0;
+
+  if (!reader->begin())
+    return -1;
+  while (reader->next(&time, &contacts, c))
+  {
+    detector->processFrame(time, contacts, c);
+    frames++;
+  }
+  return frames;
+}
+
+void printGestureRecord(Print *out, const GestureRecord *rec)
+{
+  out->print(rec->type);
+  out->print(" ");
+  out->print(rec->indx);
+  out->print(" ");
+  out->print(rec->x);
+  out->print(" ");
+  out->print(rec->y);
+  out->print(" ");
+  out->print(rec->dx);
+  out->print(" ");
+  out->print(rec->dy);
+  out->print(" ");
+  out->print(rec->sx, 3);
+  out->print(" ");
+  out->println(rec->sy, 3);
+}